@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "../include/tachy.h"
+
+#define AWAIT_POINTS 64
+#define ITERATIONS 200000
+
+struct leaf_future {
+    unsigned int polls;
+};
+
+static enum tachy_poll leaf_poll(struct leaf_future *leaf) {
+    return ((++leaf->polls & 1) == 0) ? TACHY_POLL_READY : TACHY_POLL_PENDING;
+}
+
+struct machine_future {
+    struct leaf_future leaf;
+    uint64_t steps;
+    tachy_state state;
+};
+
+static enum tachy_poll machine_poll(struct machine_future *self, uint64_t *output) {
+    tachy_begin(&self->state);
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_await(leaf_poll(&self->leaf));
+    tachy_return(self->leaf.polls);
+    tachy_end;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+int main(void) {
+    uint64_t checksum = 0;
+    uint64_t resumes = 0;
+    uint64_t start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        struct machine_future machine = {0};
+        uint64_t output = 0;
+        while (machine_poll(&machine, &output) == TACHY_POLL_PENDING) {
+            resumes++;
+        }
+        checksum += output;
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    printf("%s: %d await points, %llu resumes, %.2f ns/resume (checksum %llu)\n",
+           TACHY_USE_COMPUTED_GOTO ? "computed goto" : "switch", AWAIT_POINTS,
+           (unsigned long long) resumes, (double) elapsed / (double) resumes, (unsigned long long) checksum);
+    return 0;
+}
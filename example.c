@@ -33,11 +33,16 @@ typedef struct {
     int a;
     int b;
     int c;
-    struct tachy_yield_handle yield_handle;
-    FuncFrame f;
+    int i;
+    tachy_await_slots(await,
+        struct tachy_yield_handle yield_handle;
+        FuncFrame f;
+    );
     tachy_state state;
 } FuncFrame1;
 
+tachy_frame_budget(FuncFrame1, FuncFrame1, 48);
+
 static inline FuncFrame1 func1(int a, int b) {
     return (FuncFrame1) {.a = a, .b = b, .state = 0};
 }
@@ -47,14 +52,13 @@ enum tachy_poll func1_poll(FuncFrame1 *self, int *output) {
 
     self->c = 4;
     printf("Hello world: a = %d, b = %d\n", self->a, self->b);
-    self->yield_handle = tachy_yield();
-    tachy_await(tachy_yield_poll(&self->yield_handle, NULL));
+    self->await.yield_handle = tachy_yield();
+    tachy_await(tachy_yield_poll(&self->await.yield_handle, NULL));
 
-    int i;
-    self->f = func(13);
-    tachy_await(func_poll(&self->f, &i));
+    self->await.f = func(13);
+    tachy_await_nested(&func_poll, &self->await.f, &self->i);
 
-    printf("Bye world: c = %d, i = %d\n", self->c, i);
+    printf("Bye world: c = %d, i = %d\n", self->c, self->i);
     tachy_return(64);
 
     tachy_end;
@@ -123,13 +127,18 @@ typedef struct {
     int argc;
     char **argv;
     tachy_state state;
-    FuncFrame1 fut1;
-    FuncFrame2 fut2;
+    int i;
     struct tachy_join_handle j;
     uint64_t begin;
-    struct tachy_sleep_handle sleep_handle;
+    tachy_await_slots(await,
+        FuncFrame1 fut1;
+        FuncFrame2 fut2;
+        struct tachy_sleep_handle sleep_handle;
+    );
 } MainFrame;
 
+tachy_frame_budget(MainFrame, MainFrame, TACHY_USE_COMPUTED_GOTO ? 112 : 96);
+
 static inline MainFrame async_main(int argc, char *argv[]) {
     return (MainFrame) {.argc = argc, .argv = argv, .state = 0};
 }
@@ -148,28 +157,30 @@ enum tachy_poll async_main_poll(MainFrame *self, int *output) {
     self->j = tachy_spawn(&fut3, (tachy_poll_fn) &func3_poll, sizeof(int));
 
     printf("spawning future 3 - no join\n");
-    fut3 = func3(false);
-    int err = tachy_spawn_no_join(&fut3, (tachy_poll_fn) &func3_poll, sizeof(int));
+    struct tachy_spawn_slot slot = tachy_spawn_emplace(FuncFrame3, (tachy_poll_fn) &func3_poll, sizeof(int));
+    if (slot.future != NULL) {
+        *(FuncFrame3 *) slot.future = func3(false);
+    }
+    int err = tachy_spawn_commit_no_join(&slot);
     printf("spawned future 3 no join with status %d\n", err);
 
-    int i;
-    self->fut1 = func1(28, 841);
+    self->await.fut1 = func1(28, 841);
     printf("initialised future\n");
-    tachy_await(func1_poll(&self->fut1, &i));
-    printf("finished polling future: %d\n", i);
+    tachy_await_nested(&func1_poll, &self->await.fut1, &self->i);
+    printf("finished polling future: %d\n", self->i);
 
-    self->fut2 = func2();
-    tachy_await(func2_poll(&self->fut2, &i));
+    self->await.fut2 = func2();
+    tachy_await_nested(&func2_poll, &self->await.fut2, NULL);
     printf("finished polling future\n");
 
-    tachy_await(tachy_join_poll(&self->j, &i));
-    printf("future 3 joined with status %d\n", self->j.state);
-    printf("future 3 joined with output %d\n", i);
+    tachy_await(tachy_join_poll(&self->j, &self->i));
+    printf("future 3 joined with status %d\n", (int) self->j.state);
+    printf("future 3 joined with output %d\n", self->i);
 
-    self->sleep_handle = tachy_sleep((struct tachy_duration) {.secs = 1});
+    self->await.sleep_handle = tachy_sleep((struct tachy_duration) {.secs = 1});
     self->begin = now();
     printf("Sleeping now for 1sec\n");
-    tachy_await(tachy_sleep_poll(&self->sleep_handle, NULL));
+    tachy_await(tachy_sleep_poll(&self->await.sleep_handle, NULL));
     uint64_t end = now();
     printf("Time diff = %lums\n", end - self->begin);
 
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "tachy.h"
+
+#define BUF_POOL_DEFAULT_BUF_SIZE (16 * 1024)
+
+struct pool_buf {
+    struct pool_buf *next;
+    struct buf_pool *pool;
+    char data[];
+};
+
+struct buf_pool {
+    struct pool_buf *free_list;
+    size_t buf_size;
+    size_t max_bufs;
+    struct tachy_buf_pool_stats stats;
+};
+
+void buf_pool_init(struct buf_pool *pool, size_t buf_size, size_t max_bufs);
+void buf_pool_destroy(struct buf_pool *pool);
+char *buf_pool_borrow(struct buf_pool *pool);
+void buf_pool_return(struct buf_pool *pool, char *data);
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "tachy.h"
+
+struct bufwriter_queue {
+    struct tachy_bufwriter *head;
+};
+
+void bufwriter_flush_scheduled(struct bufwriter_queue *queue);
+void bufwriter_unschedule_range(struct bufwriter_queue *queue, const void *start, size_t len);
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#include "tachy.h"
+
 #define S_TO_MS(sec) ((sec) * 1000)
 #define NS_TO_MS(nsec) ((nsec) / 1000000)
+#define MS_TO_NS(msec) ((msec) * 1000000)
+#define US_TO_NS(usec) ((usec) * 1000)
 
-void clock_init(void);
+void clock_init(enum tachy_clock_mode mode);
+bool clock_is_virtual(void);
+void clock_advance_to(uint64_t now_ms);
 uint64_t clock_now(void);
 uint64_t clock_timeout_ticks(uint64_t timeout_ms);
+uint64_t clock_precise_ns(void);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+
+#define IO_READABLE (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)
+#define IO_WRITABLE (EPOLLOUT | EPOLLHUP | EPOLLERR)
+
+struct tachy_io;
+
+typedef void (*io_event_fn)(struct tachy_io *io, uint32_t events);
+
+struct tachy_io {
+    int fd;
+    uint32_t readiness;
+    struct task *reader;
+    struct task *writer;
+    io_event_fn on_event;
+};
+
+struct tachy_io *io_register(int fd, io_event_fn on_event);
+void io_dispatch(struct tachy_io *io, uint32_t events);
+bool io_poll_ready(struct tachy_io *io, uint32_t interest);
+void io_clear_readiness(struct tachy_io *io, uint32_t interest);
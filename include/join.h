@@ -3,3 +3,4 @@
 #include "tachy.h"
 
 struct tachy_join_handle tachy_join(struct task *task, int state);
+struct tachy_join_set_handle tachy_join_set(struct task_block *block, int state);
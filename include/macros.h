@@ -11,6 +11,22 @@
     #define TACHY_UNUSED
 #endif
 
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 202311L) // C23 or later
+    #define TACHY_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) // C11 or later
+    #define TACHY_THREAD_LOCAL _Thread_local
+#else
+    #define TACHY_THREAD_LOCAL __thread
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define TACHY_CPU_RELAX() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+    #define TACHY_CPU_RELAX() __asm__ __volatile__("yield")
+#else
+    #define TACHY_CPU_RELAX()
+#endif
+
 #if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) // C11 or later
     #define TACHY_STATIC_ASSERT(cond, msg) _Static_assert(cond, TACHY_STRINGIFY(msg))
 #else
@@ -18,8 +34,15 @@
         typedef char TACHY_PASTE(static_assertion_at_line_, msg)[(cond) ? 1 : -1]
 #endif
 
+#if defined(TACHY_COMPUTED_GOTO) && (defined(__GNUC__) || defined(__clang__))
+    #define TACHY_USE_COMPUTED_GOTO 1
+#else
+    #define TACHY_USE_COMPUTED_GOTO 0
+#endif
+
 #define TACHY_LABEL __LINE__
 #define TACHY_MAX(a, b) (((a) >= (b)) ? (a) : (b))
+#define TACHY_MIN(a, b) (((a) <= (b)) ? (a) : (b))
 
 #define TACHY_PASTE_(_0, _1) _0 ## _1
 #define TACHY_PASTE(_0, _1) TACHY_PASTE_(_0, _1)
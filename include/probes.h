@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+// USDT probes under the "tachy" provider. Define TACHY_NO_PROBES to compile them out; without
+// <sys/sdt.h> they are always empty. When compiled in, arguments are evaluated at every probe site
+// whether or not a tracer is attached, so they must stay cheap and free of side effects. Define
+// TACHY_REQUIRE_PROBES to fail the build instead of silently dropping them.
+
+#if !defined(TACHY_NO_PROBES) && defined(__has_include)
+    #if __has_include(<sys/sdt.h>)
+        #include <sys/sdt.h>
+        #define TACHY_HAS_PROBES 1
+    #endif
+#endif
+
+#if defined(TACHY_REQUIRE_PROBES) && !defined(TACHY_HAS_PROBES)
+    #error TACHY_REQUIRE_PROBES is set but <sys/sdt.h> is missing or TACHY_NO_PROBES is defined
+#endif
+
+#ifdef TACHY_HAS_PROBES
+    #define TACHY_PROBE1(name, a) DTRACE_PROBE1(tachy, name, a)
+    #define TACHY_PROBE2(name, a, b) DTRACE_PROBE2(tachy, name, a, b)
+    #define TACHY_PROBE3(name, a, b, c) DTRACE_PROBE3(tachy, name, a, b, c)
+#else
+    #define TACHY_PROBE1(name, a) ((void) 0)
+    #define TACHY_PROBE2(name, a, b) ((void) 0)
+    #define TACHY_PROBE3(name, a, b, c) ((void) 0)
+#endif
+
+#define TACHY_PROBE_FN(fn) ((uintptr_t) (fn))
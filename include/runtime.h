@@ -1,6 +1,23 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+
+struct tachy_runtime *rt_current(void);
 struct time_driver *rt_time_driver(void);
+struct buf_pool *rt_buf_pool(void);
+struct signal_driver *rt_signal_driver(void);
+struct bufwriter_queue *rt_bufwriter_queue(void);
+struct watchdog *rt_watchdog(void);
+int rt_epoll_fd(void);
 struct task *rt_cur_task(void);
 void rt_wake_task(struct task *task);
+void rt_wake_task_next(struct task *task);
+void rt_wake_task_remote(struct tachy_runtime *rt, struct task *task);
 void rt_defer_task(struct task *task);
+bool rt_poll_proceed(void);
+bool rt_dropping(void);
+void rt_set_dropping(bool dropping);
+void rt_task_acquire(size_t count, size_t bytes);
+void rt_task_release(size_t count, size_t bytes);
+void rt_release_reservation(struct task *task);
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "tachy.h"
+
+struct scope_link;
+
+struct scope_link *scope_links_new(struct tachy_scope *scope, size_t count);
+void scope_links_free(struct scope_link *links);
+struct scope_link *scope_adopt(struct tachy_scope *scope, struct task *task, struct scope_link *links);
+void scope_task_finished(struct task *task);
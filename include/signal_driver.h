@@ -0,0 +1,23 @@
+#pragma once
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+
+struct signal_entry {
+    struct signal_entry *prev;
+    struct signal_entry *next;
+    struct task *task;
+    int signo;
+    bool fired;
+};
+
+struct signal_driver {
+    struct tachy_io *io;
+    sigset_t mask;
+    struct signal_entry *waiters[NSIG];
+    unsigned pending[NSIG];
+};
+
+void signal_driver_destroy(struct signal_driver *driver);
+int signal_blocked_thread_create(pthread_t *thread, void *(*start)(void *), void *arg);
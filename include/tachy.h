@@ -4,21 +4,138 @@
     #error Tachy requires c99 or later
 #endif
 
+#include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #include "macros.h"
 
+#if TACHY_USE_COMPUTED_GOTO
+typedef intptr_t tachy_state;
+#else
 typedef int32_t tachy_state;
+#endif
 
+// TACHY_POLL_ITEM is only meaningful to tachy_stream_next_poll. tachy_await and the scheduler treat
+// any other value as ready, so a stream poll_fn must never be awaited or spawned directly; both
+// assert on ITEM.
 enum tachy_poll {
     TACHY_POLL_PENDING,
-    TACHY_POLL_READY
+    TACHY_POLL_READY,
+    TACHY_POLL_ITEM,
 };
 
 typedef enum tachy_poll (*tachy_poll_fn)(void *future, void *output);
 
+enum tachy_priority {
+    TACHY_PRIORITY_HIGH,
+    TACHY_PRIORITY_NORMAL,
+    TACHY_PRIORITY_BACKGROUND,
+
+    TACHY_PRIORITY_COUNT,
+};
+
+enum tachy_idle_policy {
+    TACHY_IDLE_PARK,
+    TACHY_IDLE_SPIN,
+    TACHY_IDLE_BUSY_POLL,
+};
+
+enum tachy_clock_mode {
+    TACHY_CLOCK_MONOTONIC,
+    TACHY_CLOCK_VIRTUAL,
+};
+
+#define TACHY_POLL_HISTOGRAM_BUCKETS 32
+
+// symbol is NULL unless poll_fn is in the dynamic symbol table (link with -rdynamic). label is the
+// resume point of the innermost frame and is only recorded when built with TACHY_WATCHDOG_LABELS: a
+// line number, or the address of the goto label with TACHY_COMPUTED_GOTO.
+struct tachy_long_poll {
+    tachy_poll_fn poll_fn;
+    const char *symbol;
+    const char *label_file;
+    intptr_t label;
+    uint64_t elapsed_ns;
+};
+
+// Called on the watchdog thread while the poll may still be running, so it must not touch runtime
+// state or call into tachy; copy what it needs out of poll.
+typedef void (*tachy_watchdog_fn)(const struct tachy_long_poll *poll, void *arg);
+
+// buckets[i] counts polls that took [2^i, 2^(i+1)) ns; the last bucket is open-ended. Histograms are
+// only recorded while the watchdog is enabled, at the cost of two clock reads and a hash probe per
+// poll. Poll functions beyond the table's 256 slots are not recorded.
+struct tachy_poll_histogram {
+    tachy_poll_fn poll_fn;
+    const char *symbol;
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t buckets[TACHY_POLL_HISTOGRAM_BUCKETS];
+};
+
+struct tachy_config {
+    enum tachy_clock_mode clock_mode;
+    uint64_t seed;
+    enum tachy_idle_policy idle_policy;
+    uint64_t idle_spin_us;
+    size_t buf_pool_buf_size;
+    size_t buf_pool_max_bufs;
+    size_t max_tasks;
+    size_t max_task_bytes;
+    uint64_t watchdog_threshold_us;
+    tachy_watchdog_fn watchdog_fn;
+    void *watchdog_arg;
+};
+
+struct tachy_idle_stats {
+    uint64_t spin_ns;
+    uint64_t park_ns;
+};
+
+struct tachy_task_usage {
+    size_t live_tasks;
+    size_t task_bytes;
+    uint64_t rejected;
+};
+
+struct tachy_buf_pool_stats {
+    size_t allocated;
+    size_t in_use;
+    size_t peak_in_use;
+    uint64_t borrows;
+    uint64_t exhausted;
+};
+
+enum tachy_stdio {
+    TACHY_STDIO_INHERIT,
+    TACHY_STDIO_PIPE,
+    TACHY_STDIO_NULL,
+};
+
+struct tachy_process_config {
+    const char *path;
+    char *const *argv;
+    char *const *envp;
+    enum tachy_stdio stdin_mode;
+    enum tachy_stdio stdout_mode;
+    enum tachy_stdio stderr_mode;
+};
+
+typedef void (*tachy_conn_init_fn)(void *future, int fd, void *arg);
+
+typedef void (*tachy_shard_fn)(size_t shard_id, void *arg);
+
+struct tachy_shard_config {
+    size_t shard_count;
+    size_t ring_capacity;
+    bool pin_cpus;
+    struct tachy_config runtime_config;
+    tachy_shard_fn main;
+    void *arg;
+};
+
 enum tachy_future_state {
     TACHY_FUTURE_CREATED,
 
@@ -32,12 +149,33 @@ enum tachy_future_state {
     TACHY_SLEEP_COMPLETED,
     TACHY_SLEEP_CANCELED,
 
+    TACHY_SHARD_RECV_REGISTERED,
+    TACHY_SHARD_RECV_COMPLETED,
+
+    TACHY_FILE_SUBMITTED,
+    TACHY_FILE_COMPLETED,
+
+    TACHY_IO_COMPLETED,
+    TACHY_SERVE_BACKOFF,
+
+    TACHY_SIGNAL_REGISTERED,
+    TACHY_SIGNAL_COMPLETED,
+    TACHY_SIGNAL_CANCELED,
+
+    TACHY_ADMIT_REGISTERED,
+    TACHY_ADMIT_COMPLETED,
+    TACHY_ADMIT_CANCELED,
+
     TACHY_PLACEHOLDER_STATE,
 };
 
 enum tachy_error {
     TACHY_NO_ERROR = 0,
     TACHY_OUT_OF_MEMORY_ERROR = TACHY_PLACEHOLDER_STATE,
+    TACHY_SYSTEM_ERROR,
+    TACHY_ADMISSION_ERROR,
+    TACHY_CANCELED_ERROR,
+    TACHY_SHARD_BUSY_ERROR,
 };
 
 struct tachy_duration {
@@ -54,11 +192,180 @@ struct tachy_join_handle {
     tachy_state state;
 };
 
+struct tachy_join_set_handle {
+    struct task_block *block;
+    size_t joined;
+    tachy_state state;
+};
+
 struct tachy_sleep_handle {
     struct time_entry *entry;
     tachy_state state;
 };
 
+struct tachy_shard_recv_handle {
+    tachy_state state;
+};
+
+struct tachy_file_handle {
+    struct file_op *op;
+    tachy_state state;
+};
+
+struct tachy_io_ready_handle {
+    struct tachy_io *io;
+    uint32_t interest;
+    tachy_state state;
+};
+
+struct tachy_io_rw_handle {
+    struct tachy_io *io;
+    void *buf;
+    size_t len;
+    tachy_state state;
+};
+
+struct tachy_buf {
+    char *data;
+    int64_t len;
+};
+
+struct tachy_slice {
+    const char *data;
+    int64_t len;
+};
+
+struct tachy_bufreader {
+    struct tachy_io *io;
+    char *buf;
+    size_t capacity;
+    size_t start;
+    size_t end;
+};
+
+struct tachy_bufwriter {
+    struct tachy_io *io;
+    char *buf;
+    size_t capacity;
+    size_t start;
+    size_t end;
+    int error;
+    bool scheduled;
+    struct tachy_bufwriter *next_scheduled;
+};
+
+struct tachy_read_until_handle {
+    struct tachy_bufreader *reader;
+    char delim;
+    size_t scanned;
+    tachy_state state;
+};
+
+struct tachy_bufwrite_handle {
+    struct tachy_bufwriter *writer;
+    const char *data;
+    size_t len;
+    size_t written;
+    bool flush;
+    tachy_state state;
+};
+
+struct tachy_read_pooled_handle {
+    struct tachy_io *io;
+    tachy_state state;
+};
+
+struct tachy_accept_handle {
+    struct tachy_io *listener;
+    int *fds;
+    size_t max;
+    tachy_state state;
+};
+
+struct tachy_serve_handle {
+    struct tachy_io *listener;
+    tachy_conn_init_fn init_fn;
+    tachy_poll_fn poll_fn;
+    size_t future_size_bytes;
+    void *arg;
+    struct tachy_sleep_handle backoff;
+    tachy_state state;
+};
+
+struct tachy_udp_batch_handle {
+    struct tachy_io *io;
+    struct mmsghdr *msgs;
+    unsigned int count;
+    unsigned int done;
+    tachy_state state;
+};
+
+struct tachy_sendfile_handle {
+    struct tachy_io *out;
+    int in_fd;
+    uint64_t offset;
+    size_t count;
+    size_t transferred;
+    tachy_state state;
+};
+
+struct tachy_splice_handle {
+    struct tachy_io *in;
+    struct tachy_io *out;
+    size_t count;
+    size_t transferred;
+    tachy_state state;
+};
+
+struct tachy_signal_handle {
+    struct signal_entry *entry;
+    tachy_state state;
+};
+
+struct tachy_process_wait_handle {
+    struct tachy_process *process;
+    tachy_state state;
+};
+
+struct tachy_stream_next_handle {
+    void *stream;
+    tachy_poll_fn poll_fn;
+    char *items;
+    size_t item_size_bytes;
+    size_t max;
+    bool ended;
+    tachy_state state;
+};
+
+struct tachy_admit_handle {
+    struct tachy_admit_handle *next;
+    struct task *task;
+    size_t task_count;
+    size_t task_bytes;
+    tachy_state state;
+};
+
+// Scoped children are tracked on the owner task, so the owner can finish while its frame (and the
+// scope in it) is overwritten by the output. The scope itself must outlive its children: keep it
+// in the owner's top-level frame, not in a nested or tachy_await_slots frame that completes first.
+struct tachy_scope {
+    struct task *owner;
+    size_t live;
+    bool waiting;
+    bool closed;
+};
+
+struct tachy_scope_join_handle {
+    struct tachy_scope *scope;
+    tachy_state state;
+};
+
+struct tachy_spawn_slot {
+    struct task *task;
+    void *future;
+    int error;
+};
+
 
 // Coroutines
 
@@ -66,8 +373,39 @@ struct tachy_sleep_handle {
 #define TACHY_RETURN_CASE_1()
 #define TACHY_RETURN(_0) TACHY_PASTE(TACHY_RETURN_CASE_, _0)
 
+#ifdef TACHY_WATCHDOG_LABELS
+#define TACHY_WATCH_RESUME() tachy__watch_resume(__FILE__, (intptr_t) *_tachy_state)
+#else
+#define TACHY_WATCH_RESUME()
+#endif
+
+#if TACHY_USE_COMPUTED_GOTO
+
+#define TACHY_RESUME_LABEL TACHY_PASTE(_tachy_resume_, TACHY_LABEL)
+#define TACHY_SAVE_POINT() *_tachy_state = (tachy_state) &&TACHY_RESUME_LABEL
+#define TACHY_RESUME_POINT() TACHY_RESUME_LABEL:
+#define TACHY_SAVE_DONE() *_tachy_state = (tachy_state) &&_tachy_done
+
 #define tachy_begin(state)                                                      \
     tachy_state *_tachy_state = state;                                          \
+    TACHY_WATCH_RESUME();                                                       \
+    if (*_tachy_state != 0) goto *(void *) *_tachy_state;                       \
+    {
+
+#define tachy_end                                                               \
+    }                                                                           \
+    _tachy_done: __attribute__((unused));                                       \
+    return TACHY_POLL_READY
+
+#else
+
+#define TACHY_SAVE_POINT() *_tachy_state = TACHY_LABEL
+#define TACHY_RESUME_POINT() TACHY_FALLTHROUGH; case TACHY_LABEL:
+#define TACHY_SAVE_DONE() *_tachy_state = TACHY_LABEL
+
+#define tachy_begin(state)                                                      \
+    tachy_state *_tachy_state = state;                                          \
+    TACHY_WATCH_RESUME();                                                       \
     switch (*_tachy_state) {                                                    \
         case 0:
 
@@ -75,26 +413,72 @@ struct tachy_sleep_handle {
     }                                                                           \
     return TACHY_POLL_READY
 
+#endif
 
 #define tachy_return(...)                                                       \
     do {                                                                        \
-        *_tachy_state = TACHY_LABEL;                                            \
+        TACHY_SAVE_DONE();                                                      \
         TACHY_RETURN(TACHY_ISEMPTY(__VA_ARGS__))(__VA_ARGS__)                   \
         return TACHY_POLL_READY;                                                \
     } while(0)
 
 #define tachy_await(poll)                                                       \
     do {                                                                        \
-        *_tachy_state = TACHY_LABEL;                                            \
-        TACHY_FALLTHROUGH;                                                      \
-        case TACHY_LABEL:                                                       \
-        if ((poll) == TACHY_POLL_PENDING) return TACHY_POLL_PENDING;            \
+        TACHY_SAVE_POINT();                                                     \
+        TACHY_RESUME_POINT() {                                                  \
+            enum tachy_poll _tachy_poll = (poll);                               \
+            assert(_tachy_poll != TACHY_POLL_ITEM);                             \
+            if (_tachy_poll == TACHY_POLL_PENDING) return TACHY_POLL_PENDING;   \
+        }                                                                       \
+    } while(0)
+
+#define tachy_yield_value(value)                                                \
+    do {                                                                        \
+        TACHY_SAVE_POINT();                                                     \
+        *output = (value);                                                      \
+        return TACHY_POLL_ITEM;                                                 \
+        TACHY_RESUME_POINT();                                                   \
     } while(0)
 
+#define tachy_await_slots(name, ...)                                            \
+    union {                                                                     \
+        __VA_ARGS__                                                             \
+    } name
+
+// name is any identifier for the diagnostic, so type can be a struct tag: tachy_frame_budget(foo,
+// struct foo, 64).
+#define tachy_frame_budget(name, type, max_bytes)                               \
+    TACHY_STATIC_ASSERT(sizeof(type) <= (max_bytes), TACHY_PASTE(name, _exceeds_frame_budget))
+
+// Wakes re-poll the innermost pending nested future directly and only re-enter
+// the parents once it is ready. Every frame between the task and the leaf must
+// be waiting on that leaf alone, and the leaf must tolerate a poll after ready.
+#define tachy_await_nested(poll_fn, future, output)                             \
+    tachy_await(tachy__await_nested((tachy_poll_fn) (poll_fn), future, output))
+
+enum tachy_poll tachy__await_nested(tachy_poll_fn poll_fn, void *future, void *output);
+
 
 // Runtime
 
 bool tachy_init(void);
+bool tachy_init_with_config(const struct tachy_config *config);
+void tachy_shutdown(void);
+struct tachy_idle_stats tachy_idle_stats(void);
+size_t tachy_queue_depth(enum tachy_priority priority);
+uint64_t tachy_now_ms(void);
+uint64_t tachy_random(void);
+// The fd from tachy_get_fd is readable while tasks are ready or a timer is due. Under
+// TACHY_CLOCK_VIRTUAL it is never armed for timers: virtual time only moves inside tachy_run_once,
+// which jumps to the next timer when nothing else is ready, so keep calling it instead of waiting.
+int tachy_get_fd(void);
+size_t tachy_run_once(size_t max_tasks);
+
+// Watchdog
+
+size_t tachy_poll_histograms(struct tachy_poll_histogram *histograms, size_t max);
+void tachy_poll_histograms_reset(void);
+void tachy__watch_resume(const char *file, intptr_t label);
 
 // Task
 
@@ -107,9 +491,199 @@ bool tachy_init(void);
 #define tachy_spawn_no_join(future, poll_fn, output_size_bytes)                 \
     tachy__spawn_no_join(future, poll_fn, sizeof(*(future)), output_size_bytes)
 
+#define tachy_spawn_with_priority(future, poll_fn, output_size_bytes, priority)   \
+    tachy__spawn_with_priority(future, poll_fn, sizeof(*(future)), output_size_bytes, priority)
+
+#define tachy_spawn_n(futures, count, poll_fn, output_size_bytes)              \
+    tachy__spawn_n(futures, count, poll_fn, sizeof(*(futures)), output_size_bytes)
+
+#define tachy_spawn_emplace(future_type, poll_fn, output_size_bytes)           \
+    tachy__spawn_emplace(poll_fn, sizeof(future_type), output_size_bytes)
+
 void tachy__block_on(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes, void *output);
 struct tachy_join_handle tachy__spawn(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes, size_t output_size_bytes);
 int tachy__spawn_no_join(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes, size_t output_size_bytes);
+struct tachy_join_handle tachy__spawn_with_priority(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes,
+                                                    size_t output_size_bytes, enum tachy_priority priority);
+struct tachy_join_set_handle tachy__spawn_n(void *futures, size_t count, tachy_poll_fn poll_fn,
+                                            size_t future_size_bytes, size_t output_size_bytes);
+struct tachy_spawn_slot tachy__spawn_emplace(tachy_poll_fn poll_fn, size_t future_size_bytes, size_t output_size_bytes);
+struct tachy_join_handle tachy_spawn_commit(struct tachy_spawn_slot *slot);
+int tachy_spawn_commit_no_join(struct tachy_spawn_slot *slot);
+void tachy_spawn_abort(struct tachy_spawn_slot *slot);
+
+// Scope
+
+#define tachy_scope_spawn(scope, future, poll_fn)                               \
+    tachy__scope_spawn(scope, future, poll_fn, sizeof(*(future)))
+
+#define tachy_scope_spawn_n(scope, futures, count, poll_fn)                     \
+    tachy__scope_spawn_n(scope, futures, count, poll_fn, sizeof(*(futures)))
+
+void tachy_scope_init(struct tachy_scope *scope);
+int tachy__scope_spawn(struct tachy_scope *scope, void *future, tachy_poll_fn poll_fn, size_t future_size_bytes);
+int tachy__scope_spawn_n(struct tachy_scope *scope, void *futures, size_t count, tachy_poll_fn poll_fn,
+                         size_t future_size_bytes);
+size_t tachy_scope_live(struct tachy_scope *scope);
+void tachy_scope_cancel(struct tachy_scope *scope);
+struct tachy_scope_join_handle tachy_scope_join(struct tachy_scope *scope);
+enum tachy_poll tachy_scope_join_poll(struct tachy_scope_join_handle *handle, TACHY_UNUSED void *output);
+
+// Admission
+
+// A completed admit reserves its capacity for the admitting task's next spawns. Whatever is unused
+// is released when that task finishes or is dropped, or when the admit is canceled. Spawns that are not
+// covered by a reservation are rejected while tachy_admit callers are queued.
+
+#define tachy_admit(future_type, output_size_bytes)                             \
+    tachy__admit(1, sizeof(future_type), output_size_bytes)
+
+#define tachy_admit_n(future_type, count, output_size_bytes)                    \
+    tachy__admit(count, sizeof(future_type), output_size_bytes)
+
+struct tachy_admit_handle tachy__admit(size_t count, size_t future_size_bytes, size_t output_size_bytes);
+enum tachy_poll tachy_admit_poll(struct tachy_admit_handle *handle, TACHY_UNUSED void *output);
+void tachy_admit_cancel(struct tachy_admit_handle *handle);
+struct tachy_task_usage tachy_task_usage(void);
+
+// Shards
+
+// Each shard has a single receiver: while one task waits in tachy_shard_recv_poll, a second task
+// that finds the rings empty completes with TACHY_SHARD_BUSY_ERROR instead of waiting.
+
+bool tachy_shards_run(const struct tachy_shard_config *config);
+size_t tachy_shard_id(void);
+size_t tachy_shard_count(void);
+bool tachy_shard_send(size_t shard_id, void *message);
+struct tachy_shard_recv_handle tachy_shard_recv(void);
+enum tachy_poll tachy_shard_recv_poll(struct tachy_shard_recv_handle *handle, void **output);
+
+// File
+
+// Reads and writes on regular files are split into 1 MiB chunks that run in parallel at their
+// offsets. On O_APPEND fds and on pipes, FIFOs and ttys the offset is ignored and the transfer runs
+// in order on one thread.
+
+struct tachy_file_handle tachy_file_open(const char *path, int flags, unsigned int mode);
+struct tachy_file_handle tachy_file_read(int fd, void *buf, size_t len, uint64_t offset);
+struct tachy_file_handle tachy_file_write(int fd, const void *buf, size_t len, uint64_t offset);
+struct tachy_file_handle tachy_file_fsync(int fd);
+enum tachy_poll tachy_file_poll(struct tachy_file_handle *handle, int64_t *output);
+
+// IO
+
+// At most one task may wait for a tachy_io to become readable and one to become writable at a time.
+// This covers every future built on it: read/write, accept and serve, sendfile/splice, process wait
+// and stdio. A second concurrent waiter in the same direction asserts.
+
+struct tachy_io *tachy_io_register(int fd);
+void tachy_io_deregister(struct tachy_io *io);
+int tachy_io_fd(struct tachy_io *io);
+void tachy_io_clear_readable(struct tachy_io *io);
+void tachy_io_clear_writable(struct tachy_io *io);
+
+struct tachy_io_ready_handle tachy_io_readable(struct tachy_io *io);
+struct tachy_io_ready_handle tachy_io_writable(struct tachy_io *io);
+enum tachy_poll tachy_io_ready_poll(struct tachy_io_ready_handle *handle, TACHY_UNUSED void *output);
+
+struct tachy_io_rw_handle tachy_read(struct tachy_io *io, void *buf, size_t len);
+struct tachy_io_rw_handle tachy_write(struct tachy_io *io, const void *buf, size_t len);
+enum tachy_poll tachy_read_poll(struct tachy_io_rw_handle *handle, int64_t *output);
+enum tachy_poll tachy_write_poll(struct tachy_io_rw_handle *handle, int64_t *output);
+
+// Pooled buffers
+
+struct tachy_read_pooled_handle tachy_read_pooled(struct tachy_io *io);
+enum tachy_poll tachy_read_pooled_poll(struct tachy_read_pooled_handle *handle, struct tachy_buf *output);
+void tachy_buf_release(struct tachy_buf *buf);
+size_t tachy_buf_capacity(void);
+struct tachy_buf_pool_stats tachy_buf_pool_stats(void);
+
+// Buffered IO
+
+bool tachy_bufreader_init(struct tachy_bufreader *reader, struct tachy_io *io, size_t capacity);
+void tachy_bufreader_destroy(struct tachy_bufreader *reader);
+struct tachy_read_until_handle tachy_read_until(struct tachy_bufreader *reader, char delim);
+struct tachy_read_until_handle tachy_read_line(struct tachy_bufreader *reader);
+enum tachy_poll tachy_read_until_poll(struct tachy_read_until_handle *handle, struct tachy_slice *output);
+
+// Buffered bytes are flushed after each scheduler pass while the writer is alive. A writer that lives
+// in a task frame stops being flushed when that task finishes or is dropped; a task that returns a
+// value over its frame must destroy the writer first. destroy returns false and leaves the writer
+// intact while unflushed bytes remain and no write error has occurred.
+bool tachy_bufwriter_init(struct tachy_bufwriter *writer, struct tachy_io *io, size_t capacity);
+bool tachy_bufwriter_destroy(struct tachy_bufwriter *writer);
+struct tachy_bufwrite_handle tachy_bufwriter_write(struct tachy_bufwriter *writer, const void *data, size_t len);
+struct tachy_bufwrite_handle tachy_bufwriter_flush(struct tachy_bufwriter *writer);
+enum tachy_poll tachy_bufwriter_write_poll(struct tachy_bufwrite_handle *handle, int64_t *output);
+
+// Net
+
+// tachy_serve runs until accept fails with a permanent error. Running out of fds or kernel memory
+// (EMFILE, ENFILE, ENOBUFS, ENOMEM) pauses accepting for 100ms and then retries.
+#define tachy_serve(listener, future_type, init_fn, poll_fn, arg)                \
+    tachy__serve(listener, init_fn, poll_fn, sizeof(future_type), arg)
+
+struct tachy_io *tachy_listen(const char *host, uint16_t port, int backlog);
+struct tachy_accept_handle tachy_accept_batch(struct tachy_io *listener, int *fds, size_t max);
+enum tachy_poll tachy_accept_batch_poll(struct tachy_accept_handle *handle, int64_t *output);
+struct tachy_serve_handle tachy__serve(struct tachy_io *listener, tachy_conn_init_fn init_fn,
+                                       tachy_poll_fn poll_fn, size_t future_size_bytes, void *arg);
+enum tachy_poll tachy_serve_poll(struct tachy_serve_handle *handle, int64_t *output);
+
+// UDP
+
+struct tachy_udp_batch_handle tachy_udp_recv_batch(struct tachy_io *io, struct mmsghdr *msgs, unsigned int count);
+struct tachy_udp_batch_handle tachy_udp_send_batch(struct tachy_io *io, struct mmsghdr *msgs, unsigned int count);
+enum tachy_poll tachy_udp_recv_batch_poll(struct tachy_udp_batch_handle *handle, int64_t *output);
+enum tachy_poll tachy_udp_send_batch_poll(struct tachy_udp_batch_handle *handle, int64_t *output);
+bool tachy_udp_enable_gro(struct tachy_io *io);
+bool tachy_udp_set_gso_segment(struct tachy_io *io, uint16_t segment_size);
+size_t tachy_udp_gro_segment_size(const struct mmsghdr *msg);
+
+// Zero-copy transfer
+
+struct tachy_sendfile_handle tachy_sendfile(struct tachy_io *out, int in_fd, uint64_t offset, size_t count);
+enum tachy_poll tachy_sendfile_poll(struct tachy_sendfile_handle *handle, int64_t *output);
+struct tachy_splice_handle tachy_splice(struct tachy_io *in, struct tachy_io *out, size_t count);
+enum tachy_poll tachy_splice_poll(struct tachy_splice_handle *handle, int64_t *output);
+
+// Signal
+
+// Threads created by tachy block every signal. A watched signal is also blocked on the calling
+// thread, but threads the application starts itself must block it too, ideally before any start.
+// Once watched, a signal delivered while no task waits for it is counted and completes the next
+// tachy_signal for that number; the kernel may merge repeats of a standard signal into one.
+struct tachy_signal_handle tachy_signal(int signo);
+enum tachy_poll tachy_signal_poll(struct tachy_signal_handle *handle, TACHY_UNUSED void *output);
+void tachy_signal_cancel(struct tachy_signal_handle *handle);
+
+// Process
+
+struct tachy_process *tachy_process_spawn(const struct tachy_process_config *config);
+int tachy_process_pid(struct tachy_process *process);
+struct tachy_io *tachy_process_stdin(struct tachy_process *process);
+struct tachy_io *tachy_process_stdout(struct tachy_process *process);
+struct tachy_io *tachy_process_stderr(struct tachy_process *process);
+void tachy_process_close_stdin(struct tachy_process *process);
+bool tachy_process_kill(struct tachy_process *process, int signo);
+// Freeing a process that is still running closes its pipes and reaps it in a background task once
+// it exits; it is not killed. If that task cannot be spawned the child is left as a zombie.
+void tachy_process_free(struct tachy_process *process);
+struct tachy_process_wait_handle tachy_process_wait(struct tachy_process *process);
+enum tachy_poll tachy_process_wait_poll(struct tachy_process_wait_handle *handle, int64_t *output);
+
+// Stream
+
+#define tachy_stream_next(stream, poll_fn, item)                                \
+    tachy__stream_next(stream, (tachy_poll_fn) (poll_fn), item, sizeof(*(item)), 1)
+
+#define tachy_stream_next_batch(stream, poll_fn, items, max)                    \
+    tachy__stream_next(stream, (tachy_poll_fn) (poll_fn), items, sizeof(*(items)), max)
+
+struct tachy_stream_next_handle tachy__stream_next(void *stream, tachy_poll_fn poll_fn, void *items,
+                                                   size_t item_size_bytes, size_t max);
+enum tachy_poll tachy_stream_next_poll(struct tachy_stream_next_handle *handle, size_t *output);
 
 // Yield
 
@@ -120,6 +694,8 @@ enum tachy_poll tachy_yield_poll(struct tachy_yield_handle *handle, TACHY_UNUSED
 
 enum tachy_poll tachy_join_poll(struct tachy_join_handle *handle, void *output);
 void tachy_join_detach(struct tachy_join_handle *handle);
+enum tachy_poll tachy_join_set_poll(struct tachy_join_set_handle *handle, void *outputs);
+void tachy_join_set_detach(struct tachy_join_set_handle *handle);
 
 // Sleep
 
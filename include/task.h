@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "tachy.h"
 
@@ -9,23 +10,52 @@ enum task_state {
     TASK_RUNNING  = 0b10,
     TASK_WAITING  = 0b100,
     TASK_COMPLETE = 0b1000,
+    TASK_DEFERRED = 0b10000,
+    TASK_STARTED  = 0b100000,
+    TASK_CANCELED = 0b1000000,
 };
 
+#define TASK_ALIGN 16
+#define TASK_POLL_BUDGET 128
+
 struct task {
     struct task *next;
     tachy_poll_fn poll_fn;
     int ref_count;
-    enum task_state state;
+    int16_t budget;
+    uint8_t state;
+    uint8_t priority;
+    uint32_t remote_wakes;
+    uint32_t reserved_tasks;
     struct task *consumer;
+    struct task_block *block;
+    struct task *remote_next;
+    size_t reserved_bytes;
+    struct scope_link *scope_link;
+    tachy_poll_fn leaf_poll_fn;
+    void *leaf_future;
+    void *leaf_output;
     size_t future_size_bytes;
     size_t output_size_bytes;
     char future_or_output[];
 };
 
+TACHY_STATIC_ASSERT(sizeof(struct task) <= 112 && sizeof(struct task) % TASK_ALIGN == 0, task_header_size);
+
 struct task_list {
     struct task *head;
 };
 
+struct task_block {
+    int ref_count;
+    size_t task_count;
+    size_t task_stride;
+    char tasks[];
+};
+
+size_t task_alloc_size(size_t future_size_bytes, size_t output_size_bytes);
+size_t task_block_alloc_size(size_t count, size_t future_size_bytes, size_t output_size_bytes);
+struct task *task_alloc(tachy_poll_fn poll_fn, size_t future_size_bytes, size_t output_size_bytes);
 struct task *task_new(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes, size_t output_size_bytes);
 enum tachy_poll task_poll(struct task *task, void *output);
 void task_register_consumer(struct task *task, struct task *consumer);
@@ -33,9 +63,21 @@ bool task_try_copy_output(struct task *task, void *output);
 void task_ref_inc(struct task *task);
 void task_ref_dec(struct task *task);
 bool task_runnable(struct task *task);
+bool task_complete(struct task *task);
+bool task_deferred(struct task *task);
+bool task_canceled(struct task *task);
+void task_cancel(struct task *task);
 void task_make_runnable(struct task *task);
+void task_set_deferred(struct task *task, bool deferred);
+bool task_consume_budget(struct task *task);
+void *task_future(struct task *task);
 void *task_output(struct task *task);
 
+struct task_block *task_block_new(void *futures, size_t count, tachy_poll_fn poll_fn,
+                                  size_t future_size_bytes, size_t output_size_bytes);
+struct task *task_block_at(struct task_block *block, size_t idx);
+
 bool task_list_empty(struct task_list *list);
 void task_list_push_front(struct task_list *list, struct task *task);
+void task_list_splice_front(struct task_list *list, struct task *head, struct task *tail);
 struct task *task_list_pop_front(struct task_list *list);
@@ -8,6 +8,7 @@ struct time_entry {
     struct time_entry *next;
     struct task *task;
     uint64_t deadline;
+    int level;
 };
 
 struct time_entry_list {
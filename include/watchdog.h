@@ -0,0 +1,30 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tachy.h"
+
+#define WATCHDOG_HISTOGRAM_SLOTS 256
+
+struct watchdog {
+    bool enabled;
+    bool running;
+    uint64_t threshold_ns;
+    tachy_watchdog_fn report_fn;
+    void *report_arg;
+    pthread_t thread;
+    atomic_bool stop;
+    _Atomic uint64_t poll_start_ns;
+    _Atomic(tachy_poll_fn) poll_fn;
+    _Atomic(const char *) label_file;
+    _Atomic intptr_t label;
+    struct tachy_poll_histogram *histograms;
+};
+
+bool watchdog_init(struct watchdog *watchdog, const struct tachy_config *config);
+void watchdog_destroy(struct watchdog *watchdog);
+void watchdog_poll_begin(struct watchdog *watchdog, tachy_poll_fn poll_fn);
+void watchdog_poll_end(struct watchdog *watchdog);
@@ -0,0 +1,138 @@
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../include/buf_pool.h"
+#include "../include/io_driver.h"
+#include "../include/runtime.h"
+#include "../include/tachy.h"
+
+static struct pool_buf *header(char *data) {
+    return (struct pool_buf *) (data - offsetof(struct pool_buf, data));
+}
+
+void buf_pool_init(struct buf_pool *pool, size_t buf_size, size_t max_bufs) {
+    assert(pool != NULL);
+
+    *pool = (struct buf_pool) {
+        .free_list = NULL,
+        .buf_size = (buf_size > 0) ? buf_size : BUF_POOL_DEFAULT_BUF_SIZE,
+        .max_bufs = max_bufs,
+    };
+}
+
+void buf_pool_destroy(struct buf_pool *pool) {
+    assert(pool != NULL);
+    assert(pool->stats.in_use == 0);
+
+    for (struct pool_buf *buf = pool->free_list; buf != NULL;) {
+        struct pool_buf *next = buf->next;
+        free(buf);
+        buf = next;
+    }
+    pool->free_list = NULL;
+    pool->stats.allocated = 0;
+}
+
+char *buf_pool_borrow(struct buf_pool *pool) {
+    assert(pool != NULL);
+
+    struct pool_buf *buf = pool->free_list;
+    if (buf != NULL) {
+        pool->free_list = buf->next;
+    } else {
+        if (pool->max_bufs > 0 && pool->stats.allocated >= pool->max_bufs) {
+            pool->stats.exhausted++;
+            return NULL;
+        }
+
+        buf = malloc(sizeof(struct pool_buf) + pool->buf_size);
+        if (buf == NULL) {
+            pool->stats.exhausted++;
+            return NULL;
+        }
+        buf->pool = pool;
+        pool->stats.allocated++;
+    }
+
+    buf->next = NULL;
+    pool->stats.borrows++;
+    pool->stats.in_use++;
+    pool->stats.peak_in_use = TACHY_MAX(pool->stats.peak_in_use, pool->stats.in_use);
+    return buf->data;
+}
+
+void buf_pool_return(struct buf_pool *pool, char *data) {
+    assert(pool != NULL);
+    assert(data != NULL);
+
+    struct pool_buf *buf = header(data);
+    assert(buf->pool == pool);
+    buf->next = pool->free_list;
+    pool->free_list = buf;
+    pool->stats.in_use--;
+}
+
+struct tachy_read_pooled_handle tachy_read_pooled(struct tachy_io *io) {
+    assert(io != NULL);
+    return (struct tachy_read_pooled_handle) {.io = io, .state = TACHY_FUTURE_CREATED};
+}
+
+enum tachy_poll tachy_read_pooled_poll(struct tachy_read_pooled_handle *handle, struct tachy_buf *output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    struct buf_pool *pool = rt_buf_pool();
+    while (handle->state == TACHY_FUTURE_CREATED) {
+        if (!io_poll_ready(handle->io, IO_READABLE) || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        char *data = buf_pool_borrow(pool);
+        if (data == NULL) {
+            *output = (struct tachy_buf) {.data = NULL, .len = -ENOBUFS};
+            handle->state = TACHY_IO_COMPLETED;
+            break;
+        }
+
+        ssize_t n = read(handle->io->fd, data, pool->buf_size);
+        if (n > 0) {
+            *output = (struct tachy_buf) {.data = data, .len = n};
+            handle->state = TACHY_IO_COMPLETED;
+            break;
+        }
+
+        int err = errno;
+        buf_pool_return(pool, data);
+        if (n == -1 && err == EINTR) {
+            continue;
+        }
+
+        if (n == -1 && (err == EAGAIN || err == EWOULDBLOCK)) {
+            io_clear_readiness(handle->io, IO_READABLE);
+            continue;
+        }
+
+        *output = (struct tachy_buf) {.data = NULL, .len = (n == 0) ? 0 : -err};
+        handle->state = TACHY_IO_COMPLETED;
+    }
+    return TACHY_POLL_READY;
+}
+
+void tachy_buf_release(struct tachy_buf *buf) {
+    assert(buf != NULL);
+
+    if (buf->data != NULL) {
+        buf_pool_return(rt_buf_pool(), buf->data);
+    }
+    *buf = (struct tachy_buf) {.data = NULL, .len = 0};
+}
+
+size_t tachy_buf_capacity(void) {
+    return rt_buf_pool()->buf_size;
+}
+
+struct tachy_buf_pool_stats tachy_buf_pool_stats(void) {
+    return rt_buf_pool()->stats;
+}
@@ -0,0 +1,336 @@
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "../include/bufio.h"
+#include "../include/io_driver.h"
+#include "../include/runtime.h"
+#include "../include/tachy.h"
+
+bool tachy_bufreader_init(struct tachy_bufreader *reader, struct tachy_io *io, size_t capacity) {
+    assert(reader != NULL);
+    assert(io != NULL);
+    assert(capacity > 0);
+
+    char *buf = malloc(capacity);
+    if (buf == NULL) {
+        return false;
+    }
+
+    *reader = (struct tachy_bufreader) {.io = io, .buf = buf, .capacity = capacity, .start = 0, .end = 0};
+    return true;
+}
+
+void tachy_bufreader_destroy(struct tachy_bufreader *reader) {
+    assert(reader != NULL);
+
+    free(reader->buf);
+    *reader = (struct tachy_bufreader) {0};
+}
+
+struct tachy_read_until_handle tachy_read_until(struct tachy_bufreader *reader, char delim) {
+    assert(reader != NULL);
+    return (struct tachy_read_until_handle) {.reader = reader, .delim = delim, .scanned = 0, .state = TACHY_FUTURE_CREATED};
+}
+
+struct tachy_read_until_handle tachy_read_line(struct tachy_bufreader *reader) {
+    return tachy_read_until(reader, '\n');
+}
+
+static void take(struct tachy_bufreader *reader, size_t len, struct tachy_slice *output) {
+    *output = (struct tachy_slice) {.data = reader->buf + reader->start, .len = (int64_t) len};
+    reader->start += len;
+}
+
+enum tachy_poll tachy_read_until_poll(struct tachy_read_until_handle *handle, struct tachy_slice *output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    struct tachy_bufreader *reader = handle->reader;
+    while (handle->state == TACHY_FUTURE_CREATED) {
+        char *scan = reader->buf + reader->start + handle->scanned;
+        char *found = memchr(scan, handle->delim, reader->end - reader->start - handle->scanned);
+        if (found != NULL) {
+            if (!rt_poll_proceed()) {
+                return TACHY_POLL_PENDING;
+            }
+
+            take(reader, (size_t) (found + 1 - (reader->buf + reader->start)), output);
+            handle->state = TACHY_IO_COMPLETED;
+            break;
+        }
+        handle->scanned = reader->end - reader->start;
+
+        if (reader->end == reader->capacity) {
+            if (reader->start == 0) {
+                *output = (struct tachy_slice) {.data = NULL, .len = -ENOBUFS};
+                handle->state = TACHY_IO_COMPLETED;
+                break;
+            }
+
+            memmove(reader->buf, reader->buf + reader->start, reader->end - reader->start);
+            reader->end -= reader->start;
+            reader->start = 0;
+        }
+
+        if (!io_poll_ready(reader->io, IO_READABLE) || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        ssize_t n = read(reader->io->fd, reader->buf + reader->end, reader->capacity - reader->end);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            io_clear_readiness(reader->io, IO_READABLE);
+            continue;
+        }
+
+        if (n == -1) {
+            *output = (struct tachy_slice) {.data = NULL, .len = -errno};
+            handle->state = TACHY_IO_COMPLETED;
+            break;
+        }
+
+        if (n == 0) {
+            take(reader, reader->end - reader->start, output);
+            handle->state = TACHY_IO_COMPLETED;
+            break;
+        }
+        reader->end += (size_t) n;
+    }
+    return TACHY_POLL_READY;
+}
+
+bool tachy_bufwriter_init(struct tachy_bufwriter *writer, struct tachy_io *io, size_t capacity) {
+    assert(writer != NULL);
+    assert(io != NULL);
+    assert(capacity > 0);
+
+    char *buf = malloc(capacity);
+    if (buf == NULL) {
+        return false;
+    }
+
+    *writer = (struct tachy_bufwriter) {
+        .io = io,
+        .buf = buf,
+        .capacity = capacity,
+        .start = 0,
+        .end = 0,
+        .error = 0,
+        .scheduled = false,
+        .next_scheduled = NULL,
+    };
+    return true;
+}
+
+static void unschedule(struct tachy_bufwriter *writer) {
+    if (!writer->scheduled) {
+        return;
+    }
+
+    struct tachy_bufwriter **link = &rt_bufwriter_queue()->head;
+    while (*link != writer) {
+        link = &(*link)->next_scheduled;
+    }
+    *link = writer->next_scheduled;
+    writer->scheduled = false;
+    writer->next_scheduled = NULL;
+}
+
+bool tachy_bufwriter_destroy(struct tachy_bufwriter *writer) {
+    assert(writer != NULL);
+
+    if (writer->end > writer->start && writer->error == 0) {
+        return false;
+    }
+
+    unschedule(writer);
+    free(writer->buf);
+    *writer = (struct tachy_bufwriter) {0};
+    return true;
+}
+
+static void schedule(struct tachy_bufwriter *writer) {
+    if (writer->scheduled) {
+        return;
+    }
+
+    struct bufwriter_queue *queue = rt_bufwriter_queue();
+    writer->scheduled = true;
+    writer->next_scheduled = queue->head;
+    queue->head = writer;
+}
+
+static void consume(struct tachy_bufwriter *writer, size_t n) {
+    writer->start += n;
+    if (writer->start == writer->end) {
+        writer->start = 0;
+        writer->end = 0;
+    }
+}
+
+static void flush_ready(struct tachy_bufwriter *writer) {
+    while (writer->end > writer->start && writer->error == 0 && (writer->io->readiness & IO_WRITABLE) != 0) {
+        ssize_t n = write(writer->io->fd, writer->buf + writer->start, writer->end - writer->start);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            io_clear_readiness(writer->io, IO_WRITABLE);
+            break;
+        }
+
+        if (n == -1) {
+            writer->error = errno;
+            break;
+        }
+        consume(writer, (size_t) n);
+    }
+}
+
+void bufwriter_flush_scheduled(struct bufwriter_queue *queue) {
+    assert(queue != NULL);
+
+    struct tachy_bufwriter *writer = queue->head;
+    queue->head = NULL;
+    while (writer != NULL) {
+        struct tachy_bufwriter *next = writer->next_scheduled;
+        writer->scheduled = false;
+        writer->next_scheduled = NULL;
+        flush_ready(writer);
+        if (writer->end > writer->start && writer->error == 0) {
+            schedule(writer);
+        }
+        writer = next;
+    }
+}
+
+// Called when a task's frame is released, so the queue never keeps a writer that lived in it.
+void bufwriter_unschedule_range(struct bufwriter_queue *queue, const void *start, size_t len) {
+    assert(queue != NULL);
+
+    const char *begin = start;
+    struct tachy_bufwriter **link = &queue->head;
+    while (*link != NULL) {
+        struct tachy_bufwriter *writer = *link;
+        if ((const char *) writer >= begin && (const char *) writer < begin + len) {
+            *link = writer->next_scheduled;
+            writer->scheduled = false;
+            writer->next_scheduled = NULL;
+        } else {
+            link = &writer->next_scheduled;
+        }
+    }
+}
+
+struct tachy_bufwrite_handle tachy_bufwriter_write(struct tachy_bufwriter *writer, const void *data, size_t len) {
+    assert(writer != NULL);
+    assert(data != NULL || len == 0);
+    return (struct tachy_bufwrite_handle) {
+        .writer = writer,
+        .data = data,
+        .len = len,
+        .written = 0,
+        .flush = false,
+        .state = TACHY_FUTURE_CREATED,
+    };
+}
+
+struct tachy_bufwrite_handle tachy_bufwriter_flush(struct tachy_bufwriter *writer) {
+    struct tachy_bufwrite_handle handle = tachy_bufwriter_write(writer, NULL, 0);
+    handle.flush = true;
+    return handle;
+}
+
+static bool buffer(struct tachy_bufwriter *writer, const char *data, size_t len) {
+    if (len > writer->capacity - (writer->end - writer->start)) {
+        return false;
+    }
+
+    if (len > writer->capacity - writer->end) {
+        memmove(writer->buf, writer->buf + writer->start, writer->end - writer->start);
+        writer->end -= writer->start;
+        writer->start = 0;
+    }
+
+    memcpy(writer->buf + writer->end, data, len);
+    writer->end += len;
+    schedule(writer);
+    return true;
+}
+
+enum tachy_poll tachy_bufwriter_write_poll(struct tachy_bufwrite_handle *handle, int64_t *output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    struct tachy_bufwriter *writer = handle->writer;
+    if (rt_dropping()) {
+        unschedule(writer);
+        return TACHY_POLL_PENDING;
+    }
+
+    while (handle->state == TACHY_FUTURE_CREATED) {
+        if (writer->error != 0) {
+            *output = -writer->error;
+            handle->state = TACHY_IO_COMPLETED;
+            break;
+        }
+
+        size_t buffered = writer->end - writer->start;
+        size_t remaining = handle->len - handle->written;
+        bool done = handle->flush ? buffered == 0 : remaining <= writer->capacity - buffered;
+        if (done) {
+            if (!rt_poll_proceed()) {
+                return TACHY_POLL_PENDING;
+            }
+
+            if (remaining > 0) {
+                buffer(writer, handle->data + handle->written, remaining);
+            }
+            *output = (int64_t) handle->len;
+            handle->state = TACHY_IO_COMPLETED;
+            break;
+        }
+
+        if (!io_poll_ready(writer->io, IO_WRITABLE) || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        struct iovec iov[2];
+        int iov_count = 0;
+        if (buffered > 0) {
+            iov[iov_count++] = (struct iovec) {.iov_base = writer->buf + writer->start, .iov_len = buffered};
+        }
+
+        if (remaining > 0) {
+            iov[iov_count++] = (struct iovec) {.iov_base = (void *) (handle->data + handle->written), .iov_len = remaining};
+        }
+
+        ssize_t n = writev(writer->io->fd, iov, iov_count);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            io_clear_readiness(writer->io, IO_WRITABLE);
+            continue;
+        }
+
+        if (n == -1) {
+            writer->error = errno;
+            continue;
+        }
+
+        size_t from_buffer = TACHY_MIN((size_t) n, buffered);
+        consume(writer, from_buffer);
+        handle->written += (size_t) n - from_buffer;
+    }
+    return TACHY_POLL_READY;
+}
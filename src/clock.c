@@ -2,9 +2,12 @@
 #include <time.h>
 
 #include "../include/clock.h"
+#include "../include/macros.h"
 
-static struct {
+static TACHY_THREAD_LOCAL struct {
     uint64_t start_time;
+    bool virtual;
+    uint64_t virtual_now;
 } linux_clock = {0};
 
 static uint64_t now(void) {
@@ -13,15 +16,39 @@ static uint64_t now(void) {
     return S_TO_MS(ts.tv_sec) + NS_TO_MS(ts.tv_nsec);
 }
 
-void clock_init(void) {
+void clock_init(enum tachy_clock_mode mode) {
+    linux_clock.virtual = (mode == TACHY_CLOCK_VIRTUAL);
+    linux_clock.virtual_now = 0;
     linux_clock.start_time = now();
 }
 
+bool clock_is_virtual(void) {
+    return linux_clock.virtual;
+}
+
+void clock_advance_to(uint64_t now_ms) {
+    assert(linux_clock.virtual);
+
+    if (now_ms > linux_clock.virtual_now) {
+        linux_clock.virtual_now = now_ms;
+    }
+}
+
 uint64_t clock_now(void) {
     assert(linux_clock.start_time > 0);
+
+    if (linux_clock.virtual) {
+        return linux_clock.virtual_now;
+    }
     return now() - linux_clock.start_time;
 }
 
 uint64_t clock_timeout_ticks(uint64_t timeout_ms) {
     return clock_now() + timeout_ms;
 }
+
+uint64_t clock_precise_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return MS_TO_NS(S_TO_MS((uint64_t) ts.tv_sec)) + (uint64_t) ts.tv_nsec;
+}
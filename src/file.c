@@ -0,0 +1,328 @@
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/runtime.h"
+#include "../include/signal_driver.h"
+#include "../include/tachy.h"
+#include "../include/task.h"
+
+#define FILE_POOL_THREADS 4
+#define FILE_CHUNK_BYTES (1024 * 1024)
+
+enum file_op_kind {
+    FILE_OP_OPEN,
+    FILE_OP_READ,
+    FILE_OP_WRITE,
+    FILE_OP_FSYNC,
+};
+
+struct file_chunk {
+    struct file_chunk *next;
+    struct file_op *op;
+    char *buf;
+    size_t len;
+    uint64_t offset;
+    int64_t result;
+};
+
+struct file_op {
+    enum file_op_kind kind;
+    int fd;
+    bool sequential;
+    int flags;
+    unsigned int mode;
+    char *path;
+    atomic_size_t remaining;
+    atomic_int ref_count;
+    struct tachy_runtime *rt;
+    struct task *task;
+    size_t chunk_count;
+    struct file_chunk chunks[];
+};
+
+static struct {
+    pthread_once_t once;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct file_chunk *head;
+    struct file_chunk *tail;
+    bool started;
+} pool = {
+    .once = PTHREAD_ONCE_INIT,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static ssize_t transfer(struct file_chunk *chunk, bool writing, size_t done) {
+    int fd = chunk->op->fd;
+    char *buf = chunk->buf + done;
+    size_t len = chunk->len - done;
+    off_t offset = (off_t) (chunk->offset + done);
+    if (chunk->op->sequential) {
+        return writing ? write(fd, buf, len) : read(fd, buf, len);
+    }
+    return writing ? pwrite(fd, buf, len, offset) : pread(fd, buf, len, offset);
+}
+
+static int64_t run_transfer(struct file_chunk *chunk, bool write) {
+    size_t done = 0;
+    while (done < chunk->len) {
+        ssize_t n = transfer(chunk, write, done);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (done > 0) ? (int64_t) done : -errno;
+        }
+
+        if (n == 0) {
+            break;
+        }
+        done += (size_t) n;
+    }
+    return (int64_t) done;
+}
+
+static int64_t run_chunk(struct file_chunk *chunk) {
+    struct file_op *op = chunk->op;
+    switch (op->kind) {
+        case FILE_OP_OPEN: {
+            int fd = open(op->path, op->flags | O_CLOEXEC, op->mode);
+            return (fd == -1) ? -errno : fd;
+        }
+
+        case FILE_OP_READ:
+            return run_transfer(chunk, false);
+
+        case FILE_OP_WRITE:
+            return run_transfer(chunk, true);
+
+        case FILE_OP_FSYNC:
+            return (fsync(op->fd) == -1) ? -errno : 0;
+    }
+    return -EINVAL;
+}
+
+static void op_release(struct file_op *op) {
+    if (atomic_fetch_sub(&op->ref_count, 1) == 1) {
+        free(op->path);
+        free(op);
+    }
+}
+
+static void *pool_worker(TACHY_UNUSED void *arg) {
+    while (1) {
+        pthread_mutex_lock(&pool.lock);
+        while (pool.head == NULL) {
+            pthread_cond_wait(&pool.cond, &pool.lock);
+        }
+
+        struct file_chunk *chunk = pool.head;
+        pool.head = chunk->next;
+        if (pool.head == NULL) {
+            pool.tail = NULL;
+        }
+        pthread_mutex_unlock(&pool.lock);
+
+        chunk->result = run_chunk(chunk);
+
+        struct file_op *op = chunk->op;
+        if (atomic_fetch_sub(&op->remaining, 1) == 1) {
+            rt_wake_task_remote(op->rt, op->task);
+            op_release(op);
+        }
+    }
+    return NULL;
+}
+
+static void pool_start(void) {
+    for (int i = 0; i < FILE_POOL_THREADS; i++) {
+        pthread_t thread;
+        if (signal_blocked_thread_create(&thread, pool_worker, NULL) == 0) {
+            pthread_detach(thread);
+            pool.started = true;
+        }
+    }
+}
+
+static void pool_submit(struct file_op *op) {
+    for (size_t i = 0; i < op->chunk_count; i++) {
+        op->chunks[i].next = (i + 1 < op->chunk_count) ? &op->chunks[i + 1] : NULL;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    if (pool.tail != NULL) {
+        pool.tail->next = &op->chunks[0];
+    } else {
+        pool.head = &op->chunks[0];
+    }
+    pool.tail = &op->chunks[op->chunk_count - 1];
+    pthread_cond_broadcast(&pool.cond);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+// O_APPEND writes ignore the pwrite offset and pipes, FIFOs and ttys reject it, so those fds
+// transfer in order as a single chunk.
+static bool positional(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    if (flags != -1 && (flags & O_APPEND) != 0) {
+        return false;
+    }
+    return lseek(fd, 0, SEEK_CUR) != -1 || errno != ESPIPE;
+}
+
+static struct tachy_file_handle op_new(enum file_op_kind kind, int fd, char *buf, size_t len, uint64_t offset) {
+    size_t chunk_count = 1;
+    size_t chunk_bytes = SIZE_MAX;
+    bool sequential = false;
+    if (kind == FILE_OP_READ || kind == FILE_OP_WRITE) {
+        sequential = !positional(fd);
+        if (!sequential) {
+            chunk_bytes = FILE_CHUNK_BYTES;
+            chunk_count = TACHY_MAX((len + FILE_CHUNK_BYTES - 1) / FILE_CHUNK_BYTES, 1);
+        }
+    }
+
+    struct file_op *op = malloc(sizeof(struct file_op) + (chunk_count * sizeof(struct file_chunk)));
+    if (op == NULL) {
+        return (struct tachy_file_handle) {.op = NULL, .state = TACHY_OUT_OF_MEMORY_ERROR};
+    }
+
+    *op = (struct file_op) {
+        .kind = kind,
+        .fd = fd,
+        .sequential = sequential,
+        .path = NULL,
+        .rt = NULL,
+        .task = NULL,
+        .chunk_count = chunk_count,
+    };
+    atomic_init(&op->remaining, chunk_count);
+    atomic_init(&op->ref_count, 1);
+
+    for (size_t i = 0; i < chunk_count; i++) {
+        size_t chunk_offset = i * FILE_CHUNK_BYTES;
+        size_t chunk_len = len - chunk_offset;
+        op->chunks[i] = (struct file_chunk) {
+            .next = NULL,
+            .op = op,
+            .buf = (buf != NULL) ? buf + chunk_offset : NULL,
+            .len = TACHY_MIN(chunk_len, chunk_bytes),
+            .offset = offset + chunk_offset,
+            .result = 0,
+        };
+    }
+    return (struct tachy_file_handle) {.op = op, .state = TACHY_FUTURE_CREATED};
+}
+
+struct tachy_file_handle tachy_file_open(const char *path, int flags, unsigned int mode) {
+    assert(path != NULL);
+
+    struct tachy_file_handle handle = op_new(FILE_OP_OPEN, -1, NULL, 0, 0);
+    if (handle.op == NULL) {
+        return handle;
+    }
+
+    handle.op->path = strdup(path);
+    if (handle.op->path == NULL) {
+        free(handle.op);
+        return (struct tachy_file_handle) {.op = NULL, .state = TACHY_OUT_OF_MEMORY_ERROR};
+    }
+
+    handle.op->flags = flags;
+    handle.op->mode = mode;
+    return handle;
+}
+
+struct tachy_file_handle tachy_file_read(int fd, void *buf, size_t len, uint64_t offset) {
+    assert(buf != NULL || len == 0);
+    return op_new(FILE_OP_READ, fd, buf, len, offset);
+}
+
+struct tachy_file_handle tachy_file_write(int fd, const void *buf, size_t len, uint64_t offset) {
+    assert(buf != NULL || len == 0);
+    return op_new(FILE_OP_WRITE, fd, (char *) buf, len, offset);
+}
+
+struct tachy_file_handle tachy_file_fsync(int fd) {
+    return op_new(FILE_OP_FSYNC, fd, NULL, 0, 0);
+}
+
+static int64_t op_result(struct file_op *op) {
+    if (op->kind == FILE_OP_OPEN || op->kind == FILE_OP_FSYNC) {
+        return op->chunks[0].result;
+    }
+
+    int64_t total = 0;
+    for (size_t i = 0; i < op->chunk_count; i++) {
+        int64_t result = op->chunks[i].result;
+        if (result < 0) {
+            return (i == 0) ? result : total;
+        }
+
+        total += result;
+        if ((size_t) result < op->chunks[i].len) {
+            break;
+        }
+    }
+    return total;
+}
+
+enum tachy_poll tachy_file_poll(struct tachy_file_handle *handle, int64_t *output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    if (rt_dropping()) {
+        if (handle->op != NULL) {
+            op_release(handle->op);
+            handle->op = NULL;
+            handle->state = TACHY_FILE_COMPLETED;
+        }
+        return TACHY_POLL_PENDING;
+    }
+
+    if (handle->state == TACHY_OUT_OF_MEMORY_ERROR) {
+        *output = -ENOMEM;
+        return TACHY_POLL_READY;
+    }
+
+    if (handle->state == TACHY_FUTURE_CREATED) {
+        pthread_once(&pool.once, pool_start);
+        if (!pool.started) {
+            *output = -EAGAIN;
+            op_release(handle->op);
+            handle->op = NULL;
+            handle->state = TACHY_FILE_COMPLETED;
+            return TACHY_POLL_READY;
+        }
+
+        struct task *task = rt_cur_task();
+        task_ref_inc(task);
+        handle->op->rt = rt_current();
+        handle->op->task = task;
+        atomic_fetch_add(&handle->op->ref_count, 1);
+        handle->state = TACHY_FILE_SUBMITTED;
+        pool_submit(handle->op);
+        return TACHY_POLL_PENDING;
+    }
+
+    if (handle->state == TACHY_FILE_SUBMITTED) {
+        if (atomic_load(&handle->op->remaining) != 0 || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        *output = op_result(handle->op);
+        op_release(handle->op);
+        handle->op = NULL;
+        handle->state = TACHY_FILE_COMPLETED;
+    }
+    return TACHY_POLL_READY;
+}
@@ -0,0 +1,219 @@
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../include/io_driver.h"
+#include "../include/runtime.h"
+#include "../include/tachy.h"
+#include "../include/task.h"
+
+static void wake_waiter(struct task **waiter) {
+    struct task *task = *waiter;
+    if (task == NULL) {
+        return;
+    }
+
+    *waiter = NULL;
+    if (!task_complete(task)) {
+        rt_wake_task(task);
+    }
+    task_ref_dec(task);
+}
+
+// Each tachy_io has one reader and one writer slot. A slot still held by a task that completed is
+// free; any other owner means two tasks are waiting in the same direction, which would lose a wakeup.
+static void set_waiter(struct task **waiter, struct task *task) {
+    if (*waiter == task) {
+        return;
+    }
+
+    assert(*waiter == NULL || task_complete(*waiter));
+    task_ref_inc(task);
+    if (*waiter != NULL) {
+        task_ref_dec(*waiter);
+    }
+    *waiter = task;
+}
+
+void io_dispatch(struct tachy_io *io, uint32_t events) {
+    assert(io != NULL);
+
+    io->readiness |= events;
+    if (io->on_event != NULL) {
+        io->on_event(io, events);
+        return;
+    }
+
+    if ((events & IO_READABLE) != 0) {
+        wake_waiter(&io->reader);
+    }
+
+    if ((events & IO_WRITABLE) != 0) {
+        wake_waiter(&io->writer);
+    }
+}
+
+bool io_poll_ready(struct tachy_io *io, uint32_t interest) {
+    assert(io != NULL);
+    assert(interest == IO_READABLE || interest == IO_WRITABLE);
+
+    if ((io->readiness & interest) != 0 && !rt_dropping()) {
+        return true;
+    }
+
+    struct task **waiter = (interest == IO_READABLE) ? &io->reader : &io->writer;
+    if (rt_dropping()) {
+        if (*waiter == rt_cur_task()) {
+            *waiter = NULL;
+            task_ref_dec(rt_cur_task());
+        }
+        return false;
+    }
+
+    set_waiter(waiter, rt_cur_task());
+    return false;
+}
+
+void io_clear_readiness(struct tachy_io *io, uint32_t interest) {
+    assert(io != NULL);
+
+    uint32_t sticky = EPOLLHUP | EPOLLERR;
+    if (interest == IO_READABLE) {
+        sticky |= EPOLLRDHUP;
+    }
+    io->readiness &= ~(interest & ~sticky);
+}
+
+struct tachy_io *io_register(int fd, io_event_fn on_event) {
+    assert(fd >= 0);
+
+    int flags = fcntl(fd, F_GETFL);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        return NULL;
+    }
+
+    struct tachy_io *io = malloc(sizeof(struct tachy_io));
+    if (io == NULL) {
+        return NULL;
+    }
+
+    *io = (struct tachy_io) {
+        .fd = fd,
+        .readiness = EPOLLIN | EPOLLOUT,
+        .reader = NULL,
+        .writer = NULL,
+        .on_event = on_event,
+    };
+
+    struct epoll_event event = {
+        .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+        .data.ptr = io,
+    };
+    if (epoll_ctl(rt_epoll_fd(), EPOLL_CTL_ADD, fd, &event) == -1) {
+        free(io);
+        return NULL;
+    }
+    return io;
+}
+
+struct tachy_io *tachy_io_register(int fd) {
+    return io_register(fd, NULL);
+}
+
+void tachy_io_deregister(struct tachy_io *io) {
+    assert(io != NULL);
+
+    epoll_ctl(rt_epoll_fd(), EPOLL_CTL_DEL, io->fd, NULL);
+    if (io->reader != NULL) {
+        task_ref_dec(io->reader);
+    }
+
+    if (io->writer != NULL) {
+        task_ref_dec(io->writer);
+    }
+    free(io);
+}
+
+int tachy_io_fd(struct tachy_io *io) {
+    assert(io != NULL);
+    return io->fd;
+}
+
+void tachy_io_clear_readable(struct tachy_io *io) {
+    io_clear_readiness(io, IO_READABLE);
+}
+
+void tachy_io_clear_writable(struct tachy_io *io) {
+    io_clear_readiness(io, IO_WRITABLE);
+}
+
+struct tachy_io_ready_handle tachy_io_readable(struct tachy_io *io) {
+    assert(io != NULL);
+    return (struct tachy_io_ready_handle) {.io = io, .interest = IO_READABLE, .state = TACHY_FUTURE_CREATED};
+}
+
+struct tachy_io_ready_handle tachy_io_writable(struct tachy_io *io) {
+    assert(io != NULL);
+    return (struct tachy_io_ready_handle) {.io = io, .interest = IO_WRITABLE, .state = TACHY_FUTURE_CREATED};
+}
+
+enum tachy_poll tachy_io_ready_poll(struct tachy_io_ready_handle *handle, TACHY_UNUSED void *output) {
+    assert(handle != NULL);
+
+    if (handle->state == TACHY_FUTURE_CREATED) {
+        if (!io_poll_ready(handle->io, handle->interest) || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+        handle->state = TACHY_IO_COMPLETED;
+    }
+    return TACHY_POLL_READY;
+}
+
+struct tachy_io_rw_handle tachy_read(struct tachy_io *io, void *buf, size_t len) {
+    assert(io != NULL);
+    assert(buf != NULL || len == 0);
+    return (struct tachy_io_rw_handle) {.io = io, .buf = buf, .len = len, .state = TACHY_FUTURE_CREATED};
+}
+
+struct tachy_io_rw_handle tachy_write(struct tachy_io *io, const void *buf, size_t len) {
+    assert(io != NULL);
+    assert(buf != NULL || len == 0);
+    return (struct tachy_io_rw_handle) {.io = io, .buf = (void *) buf, .len = len, .state = TACHY_FUTURE_CREATED};
+}
+
+static enum tachy_poll rw_poll(struct tachy_io_rw_handle *handle, int64_t *output, uint32_t interest) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    while (handle->state == TACHY_FUTURE_CREATED) {
+        if (!io_poll_ready(handle->io, interest) || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        ssize_t n = (interest == IO_READABLE)
+            ? read(handle->io->fd, handle->buf, handle->len)
+            : write(handle->io->fd, handle->buf, handle->len);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            io_clear_readiness(handle->io, interest);
+            continue;
+        }
+
+        *output = (n == -1) ? -errno : n;
+        handle->state = TACHY_IO_COMPLETED;
+    }
+    return TACHY_POLL_READY;
+}
+
+enum tachy_poll tachy_read_poll(struct tachy_io_rw_handle *handle, int64_t *output) {
+    return rw_poll(handle, output, IO_READABLE);
+}
+
+enum tachy_poll tachy_write_poll(struct tachy_io_rw_handle *handle, int64_t *output) {
+    return rw_poll(handle, output, IO_WRITABLE);
+}
@@ -17,6 +17,13 @@ enum tachy_poll tachy_join_poll(struct tachy_join_handle *handle, void *output)
     assert(handle != NULL);
     assert(handle->state != TACHY_JOIN_DETACHED);
 
+    if (rt_dropping()) {
+        if (handle->state == TACHY_FUTURE_CREATED || handle->state == TACHY_JOIN_REGISTERED) {
+            tachy_join_detach(handle);
+        }
+        return TACHY_POLL_PENDING;
+    }
+
     if (handle->state == TACHY_FUTURE_CREATED) {
         struct task *task = rt_cur_task();
         task_register_consumer(handle->task, task);
@@ -24,12 +31,13 @@ enum tachy_poll tachy_join_poll(struct tachy_join_handle *handle, void *output)
     }
 
     if (handle->state == TACHY_JOIN_REGISTERED) {
-        if (!task_try_copy_output(handle->task, output)) {
+        if (!task_complete(handle->task) || !rt_poll_proceed()) {
             return TACHY_POLL_PENDING;
         }
 
+        task_try_copy_output(handle->task, output);
         task_register_consumer(handle->task, NULL);
-        handle->state = TACHY_JOIN_COMPLETED;
+        handle->state = task_canceled(handle->task) ? TACHY_CANCELED_ERROR : TACHY_JOIN_COMPLETED;
         task_ref_dec(handle->task);
     }
     return TACHY_POLL_READY;
@@ -38,10 +46,83 @@ enum tachy_poll tachy_join_poll(struct tachy_join_handle *handle, void *output)
 void tachy_join_detach(struct tachy_join_handle *handle) {
     assert(handle != NULL);
     assert(handle->state != TACHY_JOIN_DETACHED);
-    assert(handle->state != TACHY_JOIN_COMPLETED);
 
-    task_register_consumer(handle->task, NULL);
-    task_ref_dec(handle->task);
+    // Completed and failed handles already dropped their task reference, or never held one.
+    if (handle->state == TACHY_FUTURE_CREATED || handle->state == TACHY_JOIN_REGISTERED) {
+        task_register_consumer(handle->task, NULL);
+        task_ref_dec(handle->task);
+    }
     handle->task = NULL;
     handle->state = TACHY_JOIN_DETACHED;
 }
+
+struct tachy_join_set_handle tachy_join_set(struct task_block *block, int state) {
+    if (block != NULL) {
+        for (size_t i = 0; i < block->task_count; i++) {
+            task_ref_inc(task_block_at(block, i));
+        }
+    }
+    return (struct tachy_join_set_handle) {.block = block, .joined = 0, .state = state};
+}
+
+enum tachy_poll tachy_join_set_poll(struct tachy_join_set_handle *handle, void *outputs) {
+    assert(handle != NULL);
+    assert(handle->state != TACHY_JOIN_DETACHED);
+
+    if (rt_dropping()) {
+        if (handle->state == TACHY_FUTURE_CREATED || handle->state == TACHY_JOIN_REGISTERED) {
+            tachy_join_set_detach(handle);
+        }
+        return TACHY_POLL_PENDING;
+    }
+
+    if (handle->state == TACHY_FUTURE_CREATED) {
+        struct task *consumer = rt_cur_task();
+        for (size_t i = 0; i < handle->block->task_count; i++) {
+            task_register_consumer(task_block_at(handle->block, i), consumer);
+        }
+        handle->state = TACHY_JOIN_REGISTERED;
+    }
+
+    if (handle->state == TACHY_JOIN_REGISTERED) {
+        struct task_block *block = handle->block;
+        size_t task_count = block->task_count;
+        if (!task_complete(task_block_at(block, handle->joined)) || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        for (; handle->joined < task_count; handle->joined++) {
+            struct task *task = task_block_at(block, handle->joined);
+            void *output = (outputs != NULL)
+                ? (char *) outputs + (handle->joined * task->output_size_bytes)
+                : NULL;
+            if (!task_try_copy_output(task, output)) {
+                return TACHY_POLL_PENDING;
+            }
+
+            task_register_consumer(task, NULL);
+            task_ref_dec(task);
+        }
+
+        handle->block = NULL;
+        handle->state = TACHY_JOIN_COMPLETED;
+    }
+    return TACHY_POLL_READY;
+}
+
+void tachy_join_set_detach(struct tachy_join_set_handle *handle) {
+    assert(handle != NULL);
+    assert(handle->state != TACHY_JOIN_DETACHED);
+
+    if (handle->state == TACHY_FUTURE_CREATED || handle->state == TACHY_JOIN_REGISTERED) {
+        struct task_block *block = handle->block;
+        size_t task_count = block->task_count;
+        for (; handle->joined < task_count; handle->joined++) {
+            struct task *task = task_block_at(block, handle->joined);
+            task_register_consumer(task, NULL);
+            task_ref_dec(task);
+        }
+    }
+    handle->block = NULL;
+    handle->state = TACHY_JOIN_DETACHED;
+}
@@ -0,0 +1,196 @@
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../include/io_driver.h"
+#include "../include/runtime.h"
+#include "../include/tachy.h"
+
+static int listen_socket(const struct addrinfo *ai, int backlog) {
+    int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+    if (fd == -1) {
+        return -1;
+    }
+
+    int one = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == -1 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == -1 ||
+        bind(fd, ai->ai_addr, ai->ai_addrlen) == -1 ||
+        listen(fd, backlog) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+struct tachy_io *tachy_listen(const char *host, uint16_t port, int backlog) {
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+
+    struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+        .ai_flags = AI_PASSIVE | AI_NUMERICSERV,
+    };
+    struct addrinfo *addrs;
+    if (getaddrinfo(host, service, &hints, &addrs) != 0) {
+        return NULL;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *ai = addrs; ai != NULL && fd == -1; ai = ai->ai_next) {
+        fd = listen_socket(ai, backlog);
+    }
+    freeaddrinfo(addrs);
+    if (fd == -1) {
+        return NULL;
+    }
+
+    struct tachy_io *listener = tachy_io_register(fd);
+    if (listener == NULL) {
+        close(fd);
+    }
+    return listener;
+}
+
+#define ACCEPT_BACKOFF_MS 100
+
+static bool accept_transient(int err) {
+    return err == EINTR || err == ECONNABORTED || err == EPROTO;
+}
+
+static bool accept_exhausted(int err) {
+    return err == EMFILE || err == ENFILE || err == ENOBUFS || err == ENOMEM;
+}
+
+struct tachy_accept_handle tachy_accept_batch(struct tachy_io *listener, int *fds, size_t max) {
+    assert(listener != NULL);
+    assert(fds != NULL);
+    assert(max > 0);
+    return (struct tachy_accept_handle) {.listener = listener, .fds = fds, .max = max, .state = TACHY_FUTURE_CREATED};
+}
+
+enum tachy_poll tachy_accept_batch_poll(struct tachy_accept_handle *handle, int64_t *output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    if (handle->state == TACHY_IO_COMPLETED) {
+        return TACHY_POLL_READY;
+    }
+
+    size_t count = 0;
+    while (count == 0) {
+        if (!io_poll_ready(handle->listener, IO_READABLE) || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        while (count < handle->max) {
+            int fd = accept4(handle->listener->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd != -1) {
+                handle->fds[count++] = fd;
+                continue;
+            }
+
+            if (accept_transient(errno)) {
+                continue;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                io_clear_readiness(handle->listener, IO_READABLE);
+                break;
+            }
+
+            if (count == 0) {
+                *output = -errno;
+                handle->state = TACHY_IO_COMPLETED;
+                return TACHY_POLL_READY;
+            }
+            break;
+        }
+    }
+
+    *output = (int64_t) count;
+    handle->state = TACHY_IO_COMPLETED;
+    return TACHY_POLL_READY;
+}
+
+struct tachy_serve_handle tachy__serve(struct tachy_io *listener, tachy_conn_init_fn init_fn,
+                                       tachy_poll_fn poll_fn, size_t future_size_bytes, void *arg)
+{
+    assert(listener != NULL);
+    assert(init_fn != NULL);
+    assert(poll_fn != NULL);
+    assert(future_size_bytes > 0);
+
+    return (struct tachy_serve_handle) {
+        .listener = listener,
+        .init_fn = init_fn,
+        .poll_fn = poll_fn,
+        .future_size_bytes = future_size_bytes,
+        .arg = arg,
+        .state = TACHY_FUTURE_CREATED,
+    };
+}
+
+static void spawn_connection(struct tachy_serve_handle *handle, int fd) {
+    struct tachy_spawn_slot slot = tachy__spawn_emplace(handle->poll_fn, handle->future_size_bytes, 0);
+    if (slot.future == NULL) {
+        close(fd);
+        return;
+    }
+
+    handle->init_fn(slot.future, fd, handle->arg);
+    tachy_spawn_commit_no_join(&slot);
+}
+
+enum tachy_poll tachy_serve_poll(struct tachy_serve_handle *handle, int64_t *output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    while (handle->state != TACHY_IO_COMPLETED) {
+        if (handle->state == TACHY_SERVE_BACKOFF) {
+            if (tachy_sleep_poll(&handle->backoff, NULL) == TACHY_POLL_PENDING) {
+                return TACHY_POLL_PENDING;
+            }
+            handle->state = TACHY_FUTURE_CREATED;
+        }
+
+        if (!io_poll_ready(handle->listener, IO_READABLE) || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        int fd = accept4(handle->listener->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd != -1) {
+            spawn_connection(handle, fd);
+            continue;
+        }
+
+        if (accept_transient(errno)) {
+            continue;
+        }
+
+        if (accept_exhausted(errno)) {
+            handle->backoff = tachy_sleep((struct tachy_duration) {.msecs = ACCEPT_BACKOFF_MS});
+            if (handle->backoff.state == TACHY_OUT_OF_MEMORY_ERROR) {
+                rt_defer_task(rt_cur_task());
+                return TACHY_POLL_PENDING;
+            }
+            handle->state = TACHY_SERVE_BACKOFF;
+            continue;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            io_clear_readiness(handle->listener, IO_READABLE);
+            continue;
+        }
+
+        *output = -errno;
+        handle->state = TACHY_IO_COMPLETED;
+    }
+    return TACHY_POLL_READY;
+}
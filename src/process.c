@@ -0,0 +1,311 @@
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/io_driver.h"
+#include "../include/runtime.h"
+#include "../include/tachy.h"
+
+#ifndef SYS_pidfd_open
+    #define SYS_pidfd_open 434
+#endif
+
+#ifndef SYS_pidfd_send_signal
+    #define SYS_pidfd_send_signal 424
+#endif
+
+extern char **environ;
+
+struct tachy_process {
+    pid_t pid;
+    struct tachy_io *pidfd;
+    struct tachy_io *stdio[3];
+    bool reaped;
+    int status;
+};
+
+static void close_pipes(int pipes[3][2]) {
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t end = 0; end < 2; end++) {
+            if (pipes[i][end] != -1) {
+                close(pipes[i][end]);
+                pipes[i][end] = -1;
+            }
+        }
+    }
+}
+
+static int stdio_actions(posix_spawn_file_actions_t *actions, enum tachy_stdio modes[3], int pipes[3][2]) {
+    for (int i = 0; i < 3; i++) {
+        int err = 0;
+        if (modes[i] == TACHY_STDIO_NULL) {
+            err = posix_spawn_file_actions_addopen(actions, i, "/dev/null", (i == 0) ? O_RDONLY : O_WRONLY, 0);
+        } else if (modes[i] == TACHY_STDIO_PIPE) {
+            if (pipe2(pipes[i], O_CLOEXEC) == -1) {
+                return errno;
+            }
+            err = posix_spawn_file_actions_adddup2(actions, (i == 0) ? pipes[i][0] : pipes[i][1], i);
+        }
+
+        if (err != 0) {
+            return err;
+        }
+    }
+    return 0;
+}
+
+// Signals watched through tachy_signal are blocked in the parent; the child starts unblocked
+// with default dispositions.
+static int spawn_attrs(posix_spawnattr_t *attr) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigset_t defaults;
+    sigfillset(&defaults);
+
+    int err = posix_spawnattr_setsigmask(attr, &mask);
+    if (err == 0) {
+        err = posix_spawnattr_setsigdefault(attr, &defaults);
+    }
+    if (err == 0) {
+        err = posix_spawnattr_setflags(attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+    }
+    return err;
+}
+
+static void release_stdio(struct tachy_process *process) {
+    for (size_t i = 0; i < 3; i++) {
+        if (process->stdio[i] != NULL) {
+            int fd = process->stdio[i]->fd;
+            tachy_io_deregister(process->stdio[i]);
+            close(fd);
+            process->stdio[i] = NULL;
+        }
+    }
+}
+
+static void process_release(struct tachy_process *process) {
+    release_stdio(process);
+    if (process->pidfd != NULL) {
+        int fd = process->pidfd->fd;
+        tachy_io_deregister(process->pidfd);
+        close(fd);
+        process->pidfd = NULL;
+    }
+}
+
+static bool register_pipes(struct tachy_process *process, int pipes[3][2]) {
+    for (size_t i = 0; i < 3; i++) {
+        int parent_end = (i == 0) ? pipes[i][1] : pipes[i][0];
+        if (parent_end == -1) {
+            continue;
+        }
+
+        process->stdio[i] = tachy_io_register(parent_end);
+        if (process->stdio[i] == NULL) {
+            return false;
+        }
+
+        if (i == 0) {
+            pipes[i][1] = -1;
+        } else {
+            pipes[i][0] = -1;
+        }
+    }
+    return true;
+}
+
+struct tachy_process *tachy_process_spawn(const struct tachy_process_config *config) {
+    assert(config != NULL);
+    assert(config->path != NULL);
+    assert(config->argv != NULL);
+
+    struct tachy_process *process = malloc(sizeof(struct tachy_process));
+    if (process == NULL) {
+        return NULL;
+    }
+    *process = (struct tachy_process) {.pid = -1, .pidfd = NULL, .stdio = {NULL, NULL, NULL}, .reaped = false};
+
+    enum tachy_stdio modes[3] = {config->stdin_mode, config->stdout_mode, config->stderr_mode};
+    int pipes[3][2] = {{-1, -1}, {-1, -1}, {-1, -1}};
+    posix_spawn_file_actions_t actions;
+    if (posix_spawn_file_actions_init(&actions) != 0) {
+        free(process);
+        return NULL;
+    }
+
+    posix_spawnattr_t attr;
+    if (posix_spawnattr_init(&attr) != 0) {
+        posix_spawn_file_actions_destroy(&actions);
+        free(process);
+        return NULL;
+    }
+
+    char *const *envp = (config->envp != NULL) ? config->envp : environ;
+    int err = spawn_attrs(&attr);
+    if (err == 0) {
+        err = stdio_actions(&actions, modes, pipes);
+    }
+    if (err == 0) {
+        err = posix_spawnp(&process->pid, config->path, &actions, &attr, config->argv, envp);
+    }
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    if (err != 0) {
+        close_pipes(pipes);
+        free(process);
+        errno = err;
+        return NULL;
+    }
+
+    for (size_t i = 0; i < 3; i++) {
+        int child_end = (i == 0) ? 0 : 1;
+        if (pipes[i][child_end] != -1) {
+            close(pipes[i][child_end]);
+            pipes[i][child_end] = -1;
+        }
+    }
+
+    int pidfd = (int) syscall(SYS_pidfd_open, process->pid, 0);
+    if (pidfd != -1) {
+        process->pidfd = tachy_io_register(pidfd);
+        if (process->pidfd == NULL) {
+            close(pidfd);
+        }
+    }
+
+    if (process->pidfd == NULL || !register_pipes(process, pipes)) {
+        err = errno;
+        close_pipes(pipes);
+        kill(process->pid, SIGKILL);
+        waitpid(process->pid, NULL, 0);
+        process_release(process);
+        free(process);
+        errno = err;
+        return NULL;
+    }
+    return process;
+}
+
+int tachy_process_pid(struct tachy_process *process) {
+    assert(process != NULL);
+    return process->pid;
+}
+
+struct tachy_io *tachy_process_stdin(struct tachy_process *process) {
+    assert(process != NULL);
+    return process->stdio[0];
+}
+
+struct tachy_io *tachy_process_stdout(struct tachy_process *process) {
+    assert(process != NULL);
+    return process->stdio[1];
+}
+
+struct tachy_io *tachy_process_stderr(struct tachy_process *process) {
+    assert(process != NULL);
+    return process->stdio[2];
+}
+
+void tachy_process_close_stdin(struct tachy_process *process) {
+    assert(process != NULL);
+
+    if (process->stdio[0] != NULL) {
+        int fd = process->stdio[0]->fd;
+        tachy_io_deregister(process->stdio[0]);
+        close(fd);
+        process->stdio[0] = NULL;
+    }
+}
+
+bool tachy_process_kill(struct tachy_process *process, int signo) {
+    assert(process != NULL);
+
+    if (process->reaped) {
+        errno = ESRCH;
+        return false;
+    }
+    return syscall(SYS_pidfd_send_signal, process->pidfd->fd, signo, NULL, 0) == 0;
+}
+
+struct reaper {
+    struct tachy_process *process;
+    struct tachy_process_wait_handle wait;
+    int64_t status;
+    tachy_state state;
+};
+
+static enum tachy_poll reaper_poll(struct reaper *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->wait = tachy_process_wait(self->process);
+    tachy_await(tachy_process_wait_poll(&self->wait, &self->status));
+    process_release(self->process);
+    free(self->process);
+    tachy_return();
+    tachy_end;
+}
+
+void tachy_process_free(struct tachy_process *process) {
+    assert(process != NULL);
+
+    if (!process->reaped && waitpid(process->pid, NULL, WNOHANG) == 0) {
+        release_stdio(process);
+        struct reaper reaper = {.process = process, .state = 0};
+        if (tachy_spawn_no_join(&reaper, (tachy_poll_fn) &reaper_poll, 0) == TACHY_FUTURE_CREATED) {
+            return;
+        }
+    }
+    process_release(process);
+    free(process);
+}
+
+struct tachy_process_wait_handle tachy_process_wait(struct tachy_process *process) {
+    assert(process != NULL);
+    return (struct tachy_process_wait_handle) {.process = process, .state = TACHY_FUTURE_CREATED};
+}
+
+enum tachy_poll tachy_process_wait_poll(struct tachy_process_wait_handle *handle, int64_t *output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    struct tachy_process *process = handle->process;
+    while (handle->state == TACHY_FUTURE_CREATED) {
+        if (process->reaped) {
+            *output = process->status;
+            handle->state = TACHY_IO_COMPLETED;
+            break;
+        }
+
+        if (!io_poll_ready(process->pidfd, IO_READABLE) || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        int status;
+        pid_t pid = waitpid(process->pid, &status, WNOHANG);
+        if (pid == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (pid == 0) {
+            io_clear_readiness(process->pidfd, IO_READABLE);
+            continue;
+        }
+
+        if (pid == -1) {
+            *output = -errno;
+            handle->state = TACHY_IO_COMPLETED;
+            break;
+        }
+
+        process->reaped = true;
+        process->status = status;
+    }
+    return TACHY_POLL_READY;
+}
@@ -1,33 +1,464 @@
 #include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
+#include "../include/buf_pool.h"
+#include "../include/bufio.h"
 #include "../include/clock.h"
+#include "../include/io_driver.h"
 #include "../include/join.h"
+#include "../include/probes.h"
 #include "../include/runtime.h"
+#include "../include/scope.h"
+#include "../include/signal_driver.h"
 #include "../include/tachy.h"
 #include "../include/task.h"
 #include "../include/time_driver.h"
+#include "../include/watchdog.h"
 
-static struct {
-    struct task_list tasks;
+#define NEXT_TASK_STREAK_MAX 3
+#define EVENTS_MAX 64
+#define SPIN_POLL_INTERVAL 64
+
+static const size_t priority_weights[TACHY_PRIORITY_COUNT] = {
+    [TACHY_PRIORITY_HIGH] = 16,
+    [TACHY_PRIORITY_NORMAL] = 4,
+    [TACHY_PRIORITY_BACKGROUND] = 1,
+};
+
+struct tachy_runtime {
+    struct task_list tasks[TACHY_PRIORITY_COUNT];
+    size_t queue_depth[TACHY_PRIORITY_COUNT];
+    enum tachy_priority serving;
+    size_t serving_credits;
+    struct task *next_task;
+    int next_task_streak;
     struct task_list deferred_tasks;
     struct time_driver time_driver;
+    struct buf_pool buf_pool;
+    struct signal_driver signal_driver;
+    struct bufwriter_queue bufwriter_queue;
+    struct watchdog watchdog;
     struct task *cur_task;
     struct task *blocked_task;
     int epoll_fd;
-} runtime = {0};
+    int wake_fd;
+    int timer_fd;
+    pthread_mutex_t remote_lock;
+    _Atomic(struct task *) remote_tasks;
+    struct tachy_config config;
+    struct tachy_idle_stats idle_stats;
+    struct tachy_task_usage task_usage;
+    struct tachy_admit_handle *admit_head;
+    struct tachy_admit_handle *admit_tail;
+    size_t reserved_tasks;
+    size_t reserved_bytes;
+    uint64_t rng_state;
+    bool dropping;
+};
+
+static TACHY_THREAD_LOCAL struct tachy_runtime runtime = {0};
+
+static void enqueue(struct task *task) {
+    task_list_push_front(&runtime.tasks[task->priority], task);
+    runtime.queue_depth[task->priority]++;
+}
+
+static bool queues_empty(void) {
+    if (runtime.next_task != NULL) {
+        return false;
+    }
+
+    for (int p = 0; p < TACHY_PRIORITY_COUNT; p++) {
+        if (!task_list_empty(&runtime.tasks[p])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static struct task *pop_queued(void) {
+    for (int i = 0; i <= TACHY_PRIORITY_COUNT; i++) {
+        enum tachy_priority p = runtime.serving;
+        if (runtime.serving_credits > 0 && !task_list_empty(&runtime.tasks[p])) {
+            runtime.serving_credits--;
+            runtime.queue_depth[p]--;
+            return task_list_pop_front(&runtime.tasks[p]);
+        }
+
+        runtime.serving = (p + 1) % TACHY_PRIORITY_COUNT;
+        runtime.serving_credits = priority_weights[runtime.serving];
+    }
+    return NULL;
+}
+
+static struct task *pop_task(void) {
+    struct task *task = runtime.next_task;
+    runtime.next_task = NULL;
+    if (task != NULL && runtime.next_task_streak < NEXT_TASK_STREAK_MAX) {
+        runtime.next_task_streak++;
+        return task;
+    }
+
+    // The queues are LIFO, so a task over the streak cap is queued only after picking the next one.
+    runtime.next_task_streak = 0;
+    struct task *queued = pop_queued();
+    if (queued == NULL) {
+        return task;
+    }
+
+    if (task != NULL) {
+        enqueue(task);
+    }
+    return queued;
+}
+
+static int park_timeout(void) {
+    if (!task_list_empty(&runtime.deferred_tasks)) {
+        return 0;
+    }
+
+    uint64_t deadline = time_next_expiration(&runtime.time_driver);
+    if (deadline == 0) {
+        return -1;
+    }
+
+    uint64_t now = clock_now();
+    if (now >= deadline) {
+        return 0;
+    }
+
+    uint64_t timeout = deadline - now;
+    return (timeout > INT_MAX) ? INT_MAX : (int) timeout;
+}
+
+// Nothing becomes ready locally while the thread is idle, so the spin watches the remote wake list and
+// only pays for epoll_wait and a clock read every SPIN_POLL_INTERVAL iterations.
+static int idle_spin(struct epoll_event *events, uint64_t spin_ns) {
+    uint64_t start = clock_precise_ns();
+    uint64_t now = start;
+    int nfds = 0;
+    for (unsigned i = 1; nfds == 0 && now - start < spin_ns; i++) {
+        TACHY_CPU_RELAX();
+        bool remote = atomic_load_explicit(&runtime.remote_tasks, memory_order_relaxed) != NULL;
+        if (remote || i % SPIN_POLL_INTERVAL == 0) {
+            nfds = epoll_wait(runtime.epoll_fd, events, EVENTS_MAX, 0);
+            now = clock_precise_ns();
+        }
+    }
+
+    runtime.idle_stats.spin_ns += now - start;
+    return nfds;
+}
+
+static int idle_park(struct epoll_event *events, int timeout_ms) {
+    uint64_t start = clock_precise_ns();
+    TACHY_PROBE1(park, timeout_ms);
+    int nfds = epoll_wait(runtime.epoll_fd, events, EVENTS_MAX, timeout_ms);
+    TACHY_PROBE1(unpark, nfds);
+    runtime.idle_stats.park_ns += clock_precise_ns() - start;
+    return nfds;
+}
+
+static int idle_advance_virtual(struct epoll_event *events) {
+    int nfds = epoll_wait(runtime.epoll_fd, events, EVENTS_MAX, 0);
+    if (nfds == 0) {
+        clock_advance_to(time_next_expiration(&runtime.time_driver));
+    }
+    return nfds;
+}
+
+static int idle_wait(struct epoll_event *events, int timeout_ms) {
+    if (timeout_ms == 0) {
+        return epoll_wait(runtime.epoll_fd, events, EVENTS_MAX, 0);
+    }
+
+    if (timeout_ms > 0 && clock_is_virtual()) {
+        return idle_advance_virtual(events);
+    }
+
+    uint64_t timeout_ns = (timeout_ms < 0) ? UINT64_MAX : MS_TO_NS((uint64_t) timeout_ms);
+    switch (runtime.config.idle_policy) {
+        case TACHY_IDLE_BUSY_POLL:
+            return idle_spin(events, timeout_ns);
+
+        case TACHY_IDLE_SPIN: {
+            uint64_t spin_ns = US_TO_NS(runtime.config.idle_spin_us);
+            if (spin_ns >= timeout_ns) {
+                return idle_spin(events, timeout_ns);
+            }
+
+            int nfds = idle_spin(events, spin_ns);
+            if (nfds != 0) {
+                return nfds;
+            }
+
+            if (timeout_ms > 0) {
+                timeout_ms -= (int) NS_TO_MS(spin_ns);
+            }
+            return idle_park(events, timeout_ms);
+        }
+
+        case TACHY_IDLE_PARK:
+        default:
+            return idle_park(events, timeout_ms);
+    }
+}
+
+static struct task *pop_remote_task(uint32_t *wakes) {
+    pthread_mutex_lock(&runtime.remote_lock);
+    struct task *task = runtime.remote_tasks;
+    if (task != NULL) {
+        runtime.remote_tasks = task->remote_next;
+        *wakes = task->remote_wakes;
+        task->remote_next = NULL;
+        task->remote_wakes = 0;
+    }
+    pthread_mutex_unlock(&runtime.remote_lock);
+    return task;
+}
+
+static void drain_remote_wakes(void) {
+    uint64_t count;
+    while (read(runtime.wake_fd, &count, sizeof(count)) > 0) {}
+
+    uint32_t wakes;
+    for (struct task *task = pop_remote_task(&wakes); task != NULL; task = pop_remote_task(&wakes)) {
+        if (!task_complete(task)) {
+            rt_wake_task(task);
+        }
+
+        for (uint32_t i = 0; i < wakes; i++) {
+            task_ref_dec(task);
+        }
+    }
+}
+
+static void dispatch_events(struct epoll_event *events, int nfds) {
+    for (int i = 0; i < nfds; i++) {
+        if (events[i].data.ptr == NULL) {
+            drain_remote_wakes();
+        } else if (events[i].data.ptr == &runtime.timer_fd) {
+            uint64_t expirations;
+            while (read(runtime.timer_fd, &expirations, sizeof(expirations)) > 0) {}
+        } else {
+            io_dispatch(events[i].data.ptr, events[i].events);
+        }
+    }
+}
+
+static void process_expired(void) {
+    uint64_t now = clock_now();
+    time_process_at(&runtime.time_driver, now);
+
+    for (struct task *task = task_list_pop_front(&runtime.deferred_tasks);
+         task != NULL; task = task_list_pop_front(&runtime.deferred_tasks)) {
+        task_set_deferred(task, false);
+        rt_wake_task(task);
+    }
+}
+
+static size_t run_ready_tasks(size_t max_tasks) {
+    size_t polled = 0;
+    while (polled < max_tasks) {
+        runtime.cur_task = pop_task();
+        if (runtime.cur_task == NULL) {
+            break;
+        }
+
+        void *output = task_output(runtime.cur_task);
+        task_poll(runtime.cur_task, output);
+        polled++;
+    }
+    runtime.cur_task = NULL;
+    bufwriter_flush_scheduled(&runtime.bufwriter_queue);
+    return polled;
+}
+
+static void arm_timer(void) {
+    int timeout_ms = queues_empty() ? park_timeout() : 0;
+    struct itimerspec spec = {0};
+    if (timeout_ms == 0) {
+        spec.it_value.tv_nsec = 1;
+    } else if (timeout_ms > 0 && !clock_is_virtual()) {
+        spec.it_value.tv_sec = timeout_ms / 1000;
+        spec.it_value.tv_nsec = (long) MS_TO_NS(timeout_ms % 1000);
+    }
+    timerfd_settime(runtime.timer_fd, 0, &spec, NULL);
+}
+
+static bool admits(size_t count, size_t bytes) {
+    struct tachy_task_usage *usage = &runtime.task_usage;
+    size_t tasks = usage->live_tasks + runtime.reserved_tasks + count;
+    size_t task_bytes = usage->task_bytes + runtime.reserved_bytes + bytes;
+    return (runtime.config.max_tasks == 0 || tasks <= runtime.config.max_tasks) &&
+           (runtime.config.max_task_bytes == 0 || task_bytes <= runtime.config.max_task_bytes);
+}
+
+static void reserve(struct task *task, size_t count, size_t bytes) {
+    assert(count <= UINT32_MAX - task->reserved_tasks);
+    task->reserved_tasks += (uint32_t) count;
+    task->reserved_bytes += bytes;
+    runtime.reserved_tasks += count;
+    runtime.reserved_bytes += bytes;
+}
+
+static void unreserve(struct task *task, size_t count, size_t bytes) {
+    count = TACHY_MIN(count, task->reserved_tasks);
+    bytes = TACHY_MIN(bytes, task->reserved_bytes);
+    task->reserved_tasks -= (uint32_t) count;
+    task->reserved_bytes -= bytes;
+    runtime.reserved_tasks -= count;
+    runtime.reserved_bytes -= bytes;
+}
+
+struct admission {
+    struct task *task;
+    size_t tasks;
+    size_t bytes;
+};
+
+// A spawn from a task that completed tachy_admit draws on that reservation first. Anything beyond a
+// reservation queues behind pending tachy_admit callers so they are not starved.
+static int admit(size_t count, size_t bytes, struct admission *admission) {
+    *admission = (struct admission) {.task = NULL, .tasks = 0, .bytes = 0};
+    struct task *task = runtime.cur_task;
+    if (task != NULL && task->reserved_tasks >= count) {
+        size_t reserved_bytes = TACHY_MIN(bytes, task->reserved_bytes);
+        unreserve(task, count, reserved_bytes);
+        if ((reserved_bytes == bytes || runtime.admit_head == NULL) && admits(count, bytes)) {
+            *admission = (struct admission) {.task = task, .tasks = count, .bytes = reserved_bytes};
+            return TACHY_NO_ERROR;
+        }
+        reserve(task, count, reserved_bytes);
+    }
+
+    if (runtime.admit_head == NULL && admits(count, bytes)) {
+        return TACHY_NO_ERROR;
+    }
+
+    runtime.task_usage.rejected++;
+    return TACHY_ADMISSION_ERROR;
+}
+
+// Puts back the reservation an admit consumed when the spawn it admitted fails to allocate.
+static void admit_undo(const struct admission *admission) {
+    if (admission->task != NULL) {
+        reserve(admission->task, admission->tasks, admission->bytes);
+    }
+}
+
+static void wake_admit_waiters(void) {
+    while (runtime.admit_head != NULL) {
+        struct tachy_admit_handle *handle = runtime.admit_head;
+        if (!admits(handle->task_count, handle->task_bytes)) {
+            break;
+        }
+
+        runtime.admit_head = handle->next;
+        if (runtime.admit_head == NULL) {
+            runtime.admit_tail = NULL;
+        }
+
+        struct task *task = handle->task;
+        handle->next = NULL;
+        handle->task = NULL;
+        if (!task_complete(task)) {
+            reserve(task, handle->task_count, handle->task_bytes);
+            handle->state = TACHY_ADMIT_COMPLETED;
+            rt_wake_task(task);
+        }
+        task_ref_dec(task);
+    }
+}
+
+static bool epoll_add(int fd, void *ptr) {
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = ptr};
+    return epoll_ctl(runtime.epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
 
 bool tachy_init(void) {
-    runtime.epoll_fd = epoll_create1(0);
+    static const struct tachy_config default_config = {0};
+    return tachy_init_with_config(&default_config);
+}
+
+bool tachy_init_with_config(const struct tachy_config *config) {
+    assert(config != NULL);
+
+    runtime.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
     if (runtime.epoll_fd == -1) {
         return false;
     }
 
-    clock_init();
+    runtime.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (runtime.wake_fd == -1) {
+        close(runtime.epoll_fd);
+        return false;
+    }
+
+    runtime.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (runtime.timer_fd == -1) {
+        close(runtime.wake_fd);
+        close(runtime.epoll_fd);
+        return false;
+    }
+
+    if (!epoll_add(runtime.wake_fd, NULL) || !epoll_add(runtime.timer_fd, &runtime.timer_fd) ||
+        !watchdog_init(&runtime.watchdog, config)) {
+        close(runtime.timer_fd);
+        close(runtime.wake_fd);
+        close(runtime.epoll_fd);
+        return false;
+    }
+
+    pthread_mutex_init(&runtime.remote_lock, NULL);
+    buf_pool_init(&runtime.buf_pool, config->buf_pool_buf_size, config->buf_pool_max_bufs);
+    runtime.serving = TACHY_PRIORITY_HIGH;
+    runtime.serving_credits = priority_weights[TACHY_PRIORITY_HIGH];
+    runtime.config = *config;
+    runtime.rng_state = config->seed;
+    clock_init(config->clock_mode);
     return true;
 }
 
+void tachy_shutdown(void) {
+    watchdog_destroy(&runtime.watchdog);
+    signal_driver_destroy(&runtime.signal_driver);
+    buf_pool_destroy(&runtime.buf_pool);
+    close(runtime.timer_fd);
+    close(runtime.wake_fd);
+    close(runtime.epoll_fd);
+    pthread_mutex_destroy(&runtime.remote_lock);
+    runtime = (struct tachy_runtime) {0};
+}
+
+struct tachy_idle_stats tachy_idle_stats(void) {
+    return runtime.idle_stats;
+}
+
+size_t tachy_queue_depth(enum tachy_priority priority) {
+    assert(priority < TACHY_PRIORITY_COUNT);
+    return runtime.queue_depth[priority];
+}
+
+uint64_t tachy_now_ms(void) {
+    return clock_now();
+}
+
+uint64_t tachy_random(void) {
+    uint64_t z = (runtime.rng_state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
 void tachy__block_on(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes, void *output) {
     assert(future != NULL);
     assert(poll_fn != NULL);
@@ -43,66 +474,353 @@ void tachy__block_on(void *future, tachy_poll_fn poll_fn, size_t future_size_byt
             }
         }
 
-        for (runtime.cur_task = task_list_pop_front(&runtime.tasks);
-             runtime.cur_task != NULL; runtime.cur_task = task_list_pop_front(&runtime.tasks)) {
-            void *output = task_output(runtime.cur_task);
-            task_poll(runtime.cur_task, output);
+        run_ready_tasks(SIZE_MAX);
+
+        while (queues_empty() && !task_runnable(runtime.blocked_task)) {
+            struct epoll_event events[EVENTS_MAX];
+            int nfds = idle_wait(events, park_timeout());
+            dispatch_events(events, nfds);
+            bufwriter_flush_scheduled(&runtime.bufwriter_queue);
+            process_expired();
         }
+    }
+}
 
-        while (task_list_empty(&runtime.tasks) && !task_runnable(runtime.blocked_task)) {
-            uint64_t now = clock_now();
-            uint64_t deadline = time_next_expiration(&runtime.time_driver);
-            if (now < deadline) {
-                uint64_t timeout = deadline - now;
-                int nfds = epoll_wait(runtime.epoll_fd, NULL, 0, timeout);
-                if (nfds != -1) {
-                    continue;
-                }
-            }
+int tachy_get_fd(void) {
+    arm_timer();
+    return runtime.epoll_fd;
+}
 
-            now = clock_now();
-            time_process_at(&runtime.time_driver, now);
+size_t tachy_run_once(size_t max_tasks) {
+    assert(max_tasks > 0);
+    assert(runtime.blocked_task == NULL);
 
-            for (struct task *task = task_list_pop_front(&runtime.deferred_tasks);
-                 task != NULL; task = task_list_pop_front(&runtime.deferred_tasks)) {
-                rt_wake_task(task);
-            }
-        }
-    }
+    struct epoll_event events[EVENTS_MAX];
+    int nfds = (clock_is_virtual() && queues_empty() && park_timeout() > 0)
+        ? idle_advance_virtual(events)
+        : epoll_wait(runtime.epoll_fd, events, EVENTS_MAX, 0);
+    dispatch_events(events, nfds);
+    process_expired();
+
+    size_t polled = run_ready_tasks(max_tasks);
+    arm_timer();
+    return polled;
 }
 
 struct tachy_join_handle tachy__spawn(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes, size_t output_size_bytes) {
+    return tachy__spawn_with_priority(future, poll_fn, future_size_bytes, output_size_bytes, TACHY_PRIORITY_NORMAL);
+}
+
+int tachy__spawn_no_join(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes, size_t output_size_bytes) {
     assert(future != NULL);
     assert(poll_fn != NULL);
     assert(future_size_bytes > 0);
 
+    struct admission admission;
+    int error = admit(1, task_alloc_size(future_size_bytes, output_size_bytes), &admission);
+    if (error != TACHY_NO_ERROR) {
+        return error;
+    }
+
     struct task *task = task_new(future, poll_fn, future_size_bytes, output_size_bytes);
     if (task == NULL) {
+        admit_undo(&admission);
+        return TACHY_OUT_OF_MEMORY_ERROR;
+    }
+
+    enqueue(task);
+    return TACHY_FUTURE_CREATED;
+}
+
+struct tachy_join_handle tachy__spawn_with_priority(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes,
+                                                    size_t output_size_bytes, enum tachy_priority priority)
+{
+    assert(future != NULL);
+    assert(poll_fn != NULL);
+    assert(future_size_bytes > 0);
+    assert(priority < TACHY_PRIORITY_COUNT);
+
+    struct admission admission;
+    int error = admit(1, task_alloc_size(future_size_bytes, output_size_bytes), &admission);
+    if (error != TACHY_NO_ERROR) {
+        return tachy_join(NULL, error);
+    }
+
+    struct task *task = task_new(future, poll_fn, future_size_bytes, output_size_bytes);
+    if (task == NULL) {
+        admit_undo(&admission);
         return tachy_join(NULL, TACHY_OUT_OF_MEMORY_ERROR);
     }
 
-    task_list_push_front(&runtime.tasks, task);
+    task->priority = priority;
+    enqueue(task);
     return tachy_join(task, TACHY_FUTURE_CREATED);
 }
 
-int tachy__spawn_no_join(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes, size_t output_size_bytes) {
+struct tachy_join_set_handle tachy__spawn_n(void *futures, size_t count, tachy_poll_fn poll_fn,
+                                            size_t future_size_bytes, size_t output_size_bytes)
+{
+    assert(futures != NULL);
+    assert(count > 0);
+    assert(poll_fn != NULL);
+    assert(future_size_bytes > 0);
+
+    struct admission admission;
+    int error = admit(count, task_block_alloc_size(count, future_size_bytes, output_size_bytes), &admission);
+    if (error != TACHY_NO_ERROR) {
+        return tachy_join_set(NULL, error);
+    }
+
+    struct task_block *block = task_block_new(futures, count, poll_fn, future_size_bytes, output_size_bytes);
+    if (block == NULL) {
+        admit_undo(&admission);
+        return tachy_join_set(NULL, TACHY_OUT_OF_MEMORY_ERROR);
+    }
+
+    struct task *head = task_block_at(block, 0);
+    struct task *tail = task_block_at(block, count - 1);
+    task_list_splice_front(&runtime.tasks[TACHY_PRIORITY_NORMAL], head, tail);
+    runtime.queue_depth[TACHY_PRIORITY_NORMAL] += count;
+    return tachy_join_set(block, TACHY_FUTURE_CREATED);
+}
+
+struct tachy_spawn_slot tachy__spawn_emplace(tachy_poll_fn poll_fn, size_t future_size_bytes, size_t output_size_bytes) {
+    assert(poll_fn != NULL);
+    assert(future_size_bytes > 0);
+
+    struct admission admission;
+    int error = admit(1, task_alloc_size(future_size_bytes, output_size_bytes), &admission);
+    if (error != TACHY_NO_ERROR) {
+        return (struct tachy_spawn_slot) {.task = NULL, .future = NULL, .error = error};
+    }
+
+    struct task *task = task_alloc(poll_fn, future_size_bytes, output_size_bytes);
+    if (task == NULL) {
+        admit_undo(&admission);
+        return (struct tachy_spawn_slot) {.task = NULL, .future = NULL, .error = TACHY_OUT_OF_MEMORY_ERROR};
+    }
+    return (struct tachy_spawn_slot) {.task = task, .future = task_future(task), .error = TACHY_NO_ERROR};
+}
+
+struct tachy_join_handle tachy_spawn_commit(struct tachy_spawn_slot *slot) {
+    assert(slot != NULL);
+
+    struct task *task = slot->task;
+    int error = slot->error;
+    *slot = (struct tachy_spawn_slot) {.task = NULL, .future = NULL, .error = TACHY_NO_ERROR};
+    if (task == NULL) {
+        return tachy_join(NULL, error);
+    }
+
+    enqueue(task);
+    return tachy_join(task, TACHY_FUTURE_CREATED);
+}
+
+int tachy_spawn_commit_no_join(struct tachy_spawn_slot *slot) {
+    assert(slot != NULL);
+
+    struct task *task = slot->task;
+    int error = slot->error;
+    *slot = (struct tachy_spawn_slot) {.task = NULL, .future = NULL, .error = TACHY_NO_ERROR};
+    if (task == NULL) {
+        return error;
+    }
+
+    enqueue(task);
+    return TACHY_FUTURE_CREATED;
+}
+
+void tachy_spawn_abort(struct tachy_spawn_slot *slot) {
+    assert(slot != NULL);
+
+    if (slot->task != NULL) {
+        task_ref_dec(slot->task);
+    }
+    *slot = (struct tachy_spawn_slot) {.task = NULL, .future = NULL, .error = TACHY_NO_ERROR};
+}
+
+int tachy__scope_spawn(struct tachy_scope *scope, void *future, tachy_poll_fn poll_fn, size_t future_size_bytes) {
+    assert(scope != NULL);
+    assert(!scope->closed);
     assert(future != NULL);
     assert(poll_fn != NULL);
     assert(future_size_bytes > 0);
 
-    struct task *task = task_new(future, poll_fn, future_size_bytes, output_size_bytes);
+    struct admission admission;
+    int error = admit(1, task_alloc_size(future_size_bytes, 0), &admission);
+    if (error != TACHY_NO_ERROR) {
+        return error;
+    }
+
+    struct scope_link *link = scope_links_new(scope, 1);
+    if (link == NULL) {
+        admit_undo(&admission);
+        return TACHY_OUT_OF_MEMORY_ERROR;
+    }
+
+    struct task *task = task_new(future, poll_fn, future_size_bytes, 0);
     if (task == NULL) {
+        scope_links_free(link);
+        admit_undo(&admission);
+        return TACHY_OUT_OF_MEMORY_ERROR;
+    }
+
+    scope_adopt(scope, task, link);
+    enqueue(task);
+    return TACHY_FUTURE_CREATED;
+}
+
+int tachy__scope_spawn_n(struct tachy_scope *scope, void *futures, size_t count, tachy_poll_fn poll_fn,
+                         size_t future_size_bytes)
+{
+    assert(scope != NULL);
+    assert(!scope->closed);
+    assert(futures != NULL);
+    assert(count > 0);
+    assert(poll_fn != NULL);
+    assert(future_size_bytes > 0);
+
+    struct admission admission;
+    int error = admit(count, task_block_alloc_size(count, future_size_bytes, 0), &admission);
+    if (error != TACHY_NO_ERROR) {
+        return error;
+    }
+
+    struct scope_link *links = scope_links_new(scope, count);
+    if (links == NULL) {
+        admit_undo(&admission);
         return TACHY_OUT_OF_MEMORY_ERROR;
     }
 
-    task_list_push_front(&runtime.tasks, task);
+    struct task_block *block = task_block_new(futures, count, poll_fn, future_size_bytes, 0);
+    if (block == NULL) {
+        scope_links_free(links);
+        admit_undo(&admission);
+        return TACHY_OUT_OF_MEMORY_ERROR;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        links = scope_adopt(scope, task_block_at(block, i), links);
+    }
+
+    struct task *head = task_block_at(block, 0);
+    struct task *tail = task_block_at(block, count - 1);
+    task_list_splice_front(&runtime.tasks[TACHY_PRIORITY_NORMAL], head, tail);
+    runtime.queue_depth[TACHY_PRIORITY_NORMAL] += count;
     return TACHY_FUTURE_CREATED;
 }
 
+struct tachy_admit_handle tachy__admit(size_t count, size_t future_size_bytes, size_t output_size_bytes) {
+    assert(count > 0);
+    assert(future_size_bytes > 0);
+
+    size_t bytes = (count == 1)
+        ? task_alloc_size(future_size_bytes, output_size_bytes)
+        : task_block_alloc_size(count, future_size_bytes, output_size_bytes);
+    return (struct tachy_admit_handle) {
+        .next = NULL,
+        .task = NULL,
+        .task_count = count,
+        .task_bytes = bytes,
+        .state = TACHY_FUTURE_CREATED,
+    };
+}
+
+enum tachy_poll tachy_admit_poll(struct tachy_admit_handle *handle, TACHY_UNUSED void *output) {
+    assert(handle != NULL);
+    assert(handle->state != TACHY_ADMIT_CANCELED);
+
+    if (rt_dropping()) {
+        if (handle->state != TACHY_ADMIT_COMPLETED) {
+            tachy_admit_cancel(handle);
+        }
+        return TACHY_POLL_PENDING;
+    }
+
+    if (handle->state == TACHY_ADMIT_COMPLETED) {
+        return TACHY_POLL_READY;
+    }
+
+    if (handle->task != NULL || runtime.admit_head != NULL || !admits(handle->task_count, handle->task_bytes)) {
+        if (handle->task == NULL) {
+            handle->task = rt_cur_task();
+            task_ref_inc(handle->task);
+            if (runtime.admit_tail != NULL) {
+                runtime.admit_tail->next = handle;
+            } else {
+                runtime.admit_head = handle;
+            }
+            runtime.admit_tail = handle;
+        }
+        handle->state = TACHY_ADMIT_REGISTERED;
+        return TACHY_POLL_PENDING;
+    }
+
+    if (!rt_poll_proceed()) {
+        return TACHY_POLL_PENDING;
+    }
+    reserve(rt_cur_task(), handle->task_count, handle->task_bytes);
+    handle->state = TACHY_ADMIT_COMPLETED;
+    return TACHY_POLL_READY;
+}
+
+void tachy_admit_cancel(struct tachy_admit_handle *handle) {
+    assert(handle != NULL);
+    assert(handle->state != TACHY_ADMIT_CANCELED);
+
+    if (handle->task != NULL) {
+        struct tachy_admit_handle *prev = NULL;
+        struct tachy_admit_handle **link = &runtime.admit_head;
+        while (*link != handle) {
+            prev = *link;
+            link = &(*link)->next;
+        }
+        *link = handle->next;
+        if (runtime.admit_tail == handle) {
+            runtime.admit_tail = prev;
+        }
+        task_ref_dec(handle->task);
+        handle->task = NULL;
+        handle->next = NULL;
+    } else if (handle->state == TACHY_ADMIT_COMPLETED) {
+        unreserve(rt_cur_task(), handle->task_count, handle->task_bytes);
+        wake_admit_waiters();
+    }
+    handle->state = TACHY_ADMIT_CANCELED;
+}
+
+struct tachy_task_usage tachy_task_usage(void) {
+    return runtime.task_usage;
+}
+
+struct tachy_runtime *rt_current(void) {
+    return &runtime;
+}
+
 struct time_driver *rt_time_driver(void) {
     return &runtime.time_driver;
 }
 
+struct buf_pool *rt_buf_pool(void) {
+    return &runtime.buf_pool;
+}
+
+struct watchdog *rt_watchdog(void) {
+    return &runtime.watchdog;
+}
+
+struct signal_driver *rt_signal_driver(void) {
+    return &runtime.signal_driver;
+}
+
+struct bufwriter_queue *rt_bufwriter_queue(void) {
+    return &runtime.bufwriter_queue;
+}
+
+int rt_epoll_fd(void) {
+    return runtime.epoll_fd;
+}
+
 struct task *rt_cur_task(void) {
     assert(runtime.cur_task != NULL);
     return runtime.cur_task;
@@ -110,17 +828,111 @@ struct task *rt_cur_task(void) {
 
 void rt_wake_task(struct task *task) {
     assert(task != NULL);
+    TACHY_PROBE1(task_wake, task);
 
-    if (task_runnable(task)) {
+    if (task_runnable(task) || task_deferred(task)) {
         return;
     }
 
     task_make_runnable(task);
     if (task != runtime.blocked_task) {
-        task_list_push_front(&runtime.tasks, task);
+        enqueue(task);
+    }
+}
+
+void rt_wake_task_next(struct task *task) {
+    assert(task != NULL);
+    TACHY_PROBE1(task_wake, task);
+
+    if (task_runnable(task) || task_deferred(task)) {
+        return;
+    }
+
+    task_make_runnable(task);
+    if (task == runtime.blocked_task) {
+        return;
+    }
+
+    if (runtime.next_task != NULL) {
+        enqueue(runtime.next_task);
+    }
+    runtime.next_task = task;
+}
+
+void rt_wake_task_remote(struct tachy_runtime *rt, struct task *task) {
+    assert(rt != NULL);
+    assert(task != NULL);
+
+    pthread_mutex_lock(&rt->remote_lock);
+    bool queued = task->remote_wakes > 0;
+    task->remote_wakes++;
+    if (!queued) {
+        task->remote_next = rt->remote_tasks;
+        rt->remote_tasks = task;
+    }
+    pthread_mutex_unlock(&rt->remote_lock);
+
+    if (!queued) {
+        uint64_t one = 1;
+        while (write(rt->wake_fd, &one, sizeof(one)) == -1 && errno == EINTR) {}
     }
 }
 
 void rt_defer_task(struct task *task) {
+    assert(task != NULL);
+
+    if (task_deferred(task)) {
+        return;
+    }
+
+    task_set_deferred(task, true);
     task_list_push_front(&runtime.deferred_tasks, task);
+    TACHY_PROBE1(task_defer, task);
+}
+
+bool rt_poll_proceed(void) {
+    if (runtime.dropping) {
+        return false;
+    }
+
+    struct task *task = rt_cur_task();
+    if (task_consume_budget(task)) {
+        return true;
+    }
+
+    rt_defer_task(task);
+    return false;
+}
+
+bool rt_dropping(void) {
+    return runtime.dropping;
+}
+
+void rt_set_dropping(bool dropping) {
+    runtime.dropping = dropping;
+}
+
+void rt_task_acquire(size_t count, size_t bytes) {
+    runtime.task_usage.live_tasks += count;
+    runtime.task_usage.task_bytes += bytes;
+}
+
+void rt_release_reservation(struct task *task) {
+    if (task->reserved_tasks == 0 && task->reserved_bytes == 0) {
+        return;
+    }
+
+    unreserve(task, task->reserved_tasks, task->reserved_bytes);
+    wake_admit_waiters();
+}
+
+void rt_task_release(size_t count, size_t bytes) {
+    assert(runtime.task_usage.live_tasks >= count);
+    assert(runtime.task_usage.task_bytes >= bytes);
+
+    runtime.task_usage.live_tasks -= count;
+    runtime.task_usage.task_bytes -= bytes;
+    if (runtime.admit_head != NULL) {
+        wake_admit_waiters();
+    }
 }
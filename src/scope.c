@@ -0,0 +1,224 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "../include/runtime.h"
+#include "../include/scope.h"
+#include "../include/tachy.h"
+#include "../include/task.h"
+
+// Allocated only for tasks that are in a scope or own scoped children, so other tasks carry a single
+// pointer. A task can be both: a child of its parent's scope and the owner of its own.
+struct scope_link {
+    struct tachy_scope *scope;
+    struct task *owner;
+    struct task *prev;
+    struct task *next;
+    struct task *children;
+    struct scope_link *spare;
+};
+
+static struct scope_link *link_new(void) {
+    struct scope_link *link = malloc(sizeof(struct scope_link));
+    if (link != NULL) {
+        *link = (struct scope_link) {
+            .scope = NULL,
+            .owner = NULL,
+            .prev = NULL,
+            .next = NULL,
+            .children = NULL,
+            .spare = NULL,
+        };
+    }
+    return link;
+}
+
+static void unlink_child(struct task *task) {
+    struct scope_link *link = task->scope_link;
+    if (link->prev != NULL) {
+        link->prev->scope_link->next = link->next;
+    } else {
+        link->owner->scope_link->children = link->next;
+    }
+
+    if (link->next != NULL) {
+        link->next->scope_link->prev = link->prev;
+    }
+    link->scope = NULL;
+    link->owner = NULL;
+    link->prev = NULL;
+    link->next = NULL;
+}
+
+static void release_link(struct task *task) {
+    struct scope_link *link = task->scope_link;
+    if (link != NULL && link->scope == NULL && link->children == NULL) {
+        free(link);
+        task->scope_link = NULL;
+    }
+}
+
+static void cancel_child(struct task *task) {
+    unlink_child(task);
+    release_link(task);
+    task_cancel(task);
+    task_ref_dec(task);
+}
+
+struct scope_link *scope_links_new(struct tachy_scope *scope, size_t count) {
+    assert(scope != NULL);
+    assert(count > 0);
+
+    struct task *owner = scope->owner;
+    if (owner->scope_link == NULL) {
+        owner->scope_link = link_new();
+        if (owner->scope_link == NULL) {
+            return NULL;
+        }
+    }
+
+    struct scope_link *links = NULL;
+    for (size_t i = 0; i < count; i++) {
+        struct scope_link *link = link_new();
+        if (link == NULL) {
+            scope_links_free(links);
+            return NULL;
+        }
+        link->spare = links;
+        links = link;
+    }
+    return links;
+}
+
+void scope_links_free(struct scope_link *links) {
+    while (links != NULL) {
+        struct scope_link *next = links->spare;
+        free(links);
+        links = next;
+    }
+}
+
+struct scope_link *scope_adopt(struct tachy_scope *scope, struct task *task, struct scope_link *links) {
+    assert(scope != NULL);
+    assert(task != NULL);
+    assert(task->scope_link == NULL);
+    assert(links != NULL);
+
+    struct scope_link *rest = links->spare;
+    struct task *owner = scope->owner;
+    struct scope_link *owner_link = owner->scope_link;
+    task_ref_inc(task);
+    task->scope_link = links;
+    *links = (struct scope_link) {
+        .scope = scope,
+        .owner = owner,
+        .prev = NULL,
+        .next = owner_link->children,
+        .children = NULL,
+        .spare = NULL,
+    };
+    if (owner_link->children != NULL) {
+        owner_link->children->scope_link->prev = task;
+    }
+    owner_link->children = task;
+    scope->live++;
+    return rest;
+}
+
+void scope_task_finished(struct task *task) {
+    assert(task != NULL);
+
+    struct scope_link *link = task->scope_link;
+    if (link == NULL) {
+        return;
+    }
+
+    struct tachy_scope *scope = link->scope;
+    if (scope != NULL) {
+        unlink_child(task);
+        scope->live--;
+        if (scope->live == 0 && scope->waiting) {
+            scope->waiting = false;
+            if (!task_complete(scope->owner)) {
+                rt_wake_task(scope->owner);
+            }
+        }
+    }
+
+    // The owner's frame may already hold its output, so its scopes are not touched here.
+    while (link->children != NULL) {
+        cancel_child(link->children);
+    }
+    release_link(task);
+    if (scope != NULL) {
+        task_ref_dec(task);
+    }
+}
+
+void tachy_scope_init(struct tachy_scope *scope) {
+    assert(scope != NULL);
+
+    *scope = (struct tachy_scope) {
+        .owner = rt_cur_task(),
+        .live = 0,
+        .waiting = false,
+        .closed = false,
+    };
+}
+
+size_t tachy_scope_live(struct tachy_scope *scope) {
+    assert(scope != NULL);
+    return scope->live;
+}
+
+void tachy_scope_cancel(struct tachy_scope *scope) {
+    assert(scope != NULL);
+
+    if (scope->closed) {
+        return;
+    }
+
+    struct scope_link *owner_link = scope->owner->scope_link;
+    struct task *task = (owner_link != NULL) ? owner_link->children : NULL;
+    while (task != NULL) {
+        struct task *next = task->scope_link->next;
+        if (task->scope_link->scope == scope) {
+            cancel_child(task);
+        }
+        task = next;
+    }
+    scope->live = 0;
+    scope->waiting = false;
+    scope->closed = true;
+}
+
+struct tachy_scope_join_handle tachy_scope_join(struct tachy_scope *scope) {
+    assert(scope != NULL);
+    return (struct tachy_scope_join_handle) {.scope = scope, .state = TACHY_FUTURE_CREATED};
+}
+
+enum tachy_poll tachy_scope_join_poll(struct tachy_scope_join_handle *handle, TACHY_UNUSED void *output) {
+    assert(handle != NULL);
+
+    if (handle->state == TACHY_JOIN_COMPLETED) {
+        return TACHY_POLL_READY;
+    }
+
+    struct tachy_scope *scope = handle->scope;
+    if (rt_dropping()) {
+        tachy_scope_cancel(scope);
+        return TACHY_POLL_PENDING;
+    }
+
+    if (scope->live > 0) {
+        scope->waiting = true;
+        return TACHY_POLL_PENDING;
+    }
+
+    if (!rt_poll_proceed()) {
+        return TACHY_POLL_PENDING;
+    }
+
+    scope->closed = true;
+    handle->state = TACHY_JOIN_COMPLETED;
+    return TACHY_POLL_READY;
+}
@@ -0,0 +1,150 @@
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+
+#include "../include/io_driver.h"
+#include "../include/runtime.h"
+#include "../include/tachy.h"
+
+static bool would_block(void) {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+static enum tachy_poll complete(tachy_state *state, size_t transferred, int err, int64_t *output) {
+    *output = (err != 0 && transferred == 0) ? -err : (int64_t) transferred;
+    *state = TACHY_IO_COMPLETED;
+    return TACHY_POLL_READY;
+}
+
+struct tachy_sendfile_handle tachy_sendfile(struct tachy_io *out, int in_fd, uint64_t offset, size_t count) {
+    assert(out != NULL);
+    assert(in_fd >= 0);
+
+    return (struct tachy_sendfile_handle) {
+        .out = out,
+        .in_fd = in_fd,
+        .offset = offset,
+        .count = count,
+        .transferred = 0,
+        .state = TACHY_FUTURE_CREATED,
+    };
+}
+
+enum tachy_poll tachy_sendfile_poll(struct tachy_sendfile_handle *handle, int64_t *output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    if (handle->state == TACHY_IO_COMPLETED) {
+        return TACHY_POLL_READY;
+    }
+
+    while (handle->transferred < handle->count) {
+        if (!io_poll_ready(handle->out, IO_WRITABLE) || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        off_t offset = (off_t) (handle->offset + handle->transferred);
+        ssize_t n = sendfile(handle->out->fd, handle->in_fd, &offset, handle->count - handle->transferred);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (would_block()) {
+                io_clear_readiness(handle->out, IO_WRITABLE);
+                continue;
+            }
+            return complete(&handle->state, handle->transferred, errno, output);
+        }
+
+        if (n == 0) {
+            break;
+        }
+        handle->transferred += (size_t) n;
+    }
+    return complete(&handle->state, handle->transferred, 0, output);
+}
+
+struct tachy_splice_handle tachy_splice(struct tachy_io *in, struct tachy_io *out, size_t count) {
+    assert(in != NULL);
+    assert(out != NULL);
+
+    return (struct tachy_splice_handle) {
+        .in = in,
+        .out = out,
+        .count = count,
+        .transferred = 0,
+        .state = TACHY_FUTURE_CREATED,
+    };
+}
+
+// splice reports EAGAIN without saying which end blocked. Only an end that poll shows as not ready
+// is cleared, since a cleared end that is still ready never gets another edge. When both look
+// ready the task retries on the next loop iteration instead.
+static bool clear_blocked_side(struct tachy_io *in, struct tachy_io *out) {
+    struct pollfd fds[2] = {
+        {.fd = in->fd, .events = POLLIN},
+        {.fd = out->fd, .events = POLLOUT},
+    };
+
+    if (poll(fds, 2, 0) == -1) {
+        return false;
+    }
+
+    bool in_ready = (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+    bool out_ready = (fds[1].revents & (POLLOUT | POLLHUP | POLLERR)) != 0;
+    if (!in_ready) {
+        io_clear_readiness(in, IO_READABLE);
+    }
+
+    if (!out_ready) {
+        io_clear_readiness(out, IO_WRITABLE);
+    }
+    return !in_ready || !out_ready;
+}
+
+enum tachy_poll tachy_splice_poll(struct tachy_splice_handle *handle, int64_t *output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    if (handle->state == TACHY_IO_COMPLETED) {
+        return TACHY_POLL_READY;
+    }
+
+    while (handle->transferred < handle->count) {
+        if (!io_poll_ready(handle->in, IO_READABLE) || !io_poll_ready(handle->out, IO_WRITABLE)) {
+            return TACHY_POLL_PENDING;
+        }
+
+        if (!rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        ssize_t n = splice(handle->in->fd, NULL, handle->out->fd, NULL,
+                           handle->count - handle->transferred, SPLICE_F_NONBLOCK | SPLICE_F_MOVE);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (would_block()) {
+                if (!clear_blocked_side(handle->in, handle->out)) {
+                    rt_defer_task(rt_cur_task());
+                    return TACHY_POLL_PENDING;
+                }
+                continue;
+            }
+            return complete(&handle->state, handle->transferred, errno, output);
+        }
+
+        if (n == 0) {
+            break;
+        }
+        handle->transferred += (size_t) n;
+    }
+    return complete(&handle->state, handle->transferred, 0, output);
+}
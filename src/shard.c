@@ -0,0 +1,338 @@
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../include/runtime.h"
+#include "../include/signal_driver.h"
+#include "../include/tachy.h"
+#include "../include/task.h"
+
+#define RING_DEFAULT_CAPACITY 1024
+#define CACHE_LINE_BYTES 64
+
+struct shard_ring {
+    _Alignas(CACHE_LINE_BYTES) atomic_size_t head;
+    _Alignas(CACHE_LINE_BYTES) atomic_size_t tail;
+    _Alignas(CACHE_LINE_BYTES) size_t mask;
+    void *slots[];
+};
+
+struct shard {
+    _Alignas(CACHE_LINE_BYTES) _Atomic(struct task *) waiter;
+    struct tachy_runtime *rt;
+    struct shard_group *group;
+    size_t id;
+    size_t recv_cursor;
+    pthread_t thread;
+    bool init_failed;
+};
+
+enum shard_start {
+    SHARD_START_WAIT,
+    SHARD_START_GO,
+    SHARD_START_CANCEL,
+};
+
+struct shard_group {
+    const struct tachy_shard_config *config;
+    size_t count;
+    struct shard *shards;
+    struct shard_ring **rings;
+    pthread_mutex_t start_lock;
+    pthread_cond_t start_cond;
+    enum shard_start start;
+    pthread_barrier_t barrier;
+};
+
+static TACHY_THREAD_LOCAL struct shard *cur_shard = NULL;
+
+static size_t round_up_pow2(size_t n) {
+    size_t pow2 = 1;
+    while (pow2 < n) {
+        pow2 <<= 1;
+    }
+    return pow2;
+}
+
+static struct shard_ring *ring_new(size_t capacity) {
+    capacity = round_up_pow2(capacity);
+    size_t bytes = sizeof(struct shard_ring) + (capacity * sizeof(void *));
+    bytes = (bytes + CACHE_LINE_BYTES - 1) & ~((size_t) CACHE_LINE_BYTES - 1);
+
+    struct shard_ring *ring = aligned_alloc(CACHE_LINE_BYTES, bytes);
+    if (ring == NULL) {
+        return NULL;
+    }
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->mask = capacity - 1;
+    return ring;
+}
+
+static bool ring_push(struct shard_ring *ring, void *message) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail - head > ring->mask) {
+        return false;
+    }
+
+    ring->slots[tail & ring->mask] = message;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_seq_cst);
+    return true;
+}
+
+static bool ring_empty(struct shard_ring *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    return atomic_load_explicit(&ring->tail, memory_order_seq_cst) == head;
+}
+
+static void *ring_pop(struct shard_ring *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    assert(atomic_load_explicit(&ring->tail, memory_order_acquire) != head);
+
+    void *message = ring->slots[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return message;
+}
+
+static struct shard_ring *ring_between(struct shard_group *group, size_t from, size_t to) {
+    return group->rings[(from * group->count) + to];
+}
+
+static struct shard_ring *next_ready_ring(struct shard *shard) {
+    struct shard_group *group = shard->group;
+    for (size_t i = 0; i < group->count; i++) {
+        size_t from = (shard->recv_cursor + i) % group->count;
+        struct shard_ring *ring = ring_between(group, from, shard->id);
+        if (!ring_empty(ring)) {
+            shard->recv_cursor = (from + 1) % group->count;
+            return ring;
+        }
+    }
+    return NULL;
+}
+
+static void pin_to_cpu(size_t id) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) {
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(id % (size_t) cpus, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static enum shard_start wait_for_start(struct shard_group *group) {
+    pthread_mutex_lock(&group->start_lock);
+    while (group->start == SHARD_START_WAIT) {
+        pthread_cond_wait(&group->start_cond, &group->start_lock);
+    }
+    enum shard_start start = group->start;
+    pthread_mutex_unlock(&group->start_lock);
+    return start;
+}
+
+static void signal_start(struct shard_group *group, enum shard_start start) {
+    pthread_mutex_lock(&group->start_lock);
+    group->start = start;
+    pthread_cond_broadcast(&group->start_cond);
+    pthread_mutex_unlock(&group->start_lock);
+}
+
+static void *shard_thread(void *arg) {
+    struct shard *shard = arg;
+    struct shard_group *group = shard->group;
+    const struct tachy_shard_config *config = group->config;
+
+    if (wait_for_start(group) == SHARD_START_CANCEL) {
+        shard->init_failed = true;
+        return NULL;
+    }
+
+    if (config->pin_cpus) {
+        pin_to_cpu(shard->id);
+    }
+
+    cur_shard = shard;
+    shard->init_failed = !tachy_init_with_config(&config->runtime_config);
+    shard->rt = rt_current();
+    pthread_barrier_wait(&group->barrier);
+
+    bool init_failed = false;
+    for (size_t i = 0; i < group->count; i++) {
+        init_failed |= group->shards[i].init_failed;
+    }
+
+    if (!init_failed) {
+        config->main(shard->id, config->arg);
+    }
+
+    pthread_barrier_wait(&group->barrier);
+    if (!shard->init_failed) {
+        tachy_shutdown();
+    }
+    cur_shard = NULL;
+    return NULL;
+}
+
+static void group_free(struct shard_group *group, size_t rings) {
+    for (size_t i = 0; i < rings; i++) {
+        free(group->rings[i]);
+    }
+    free(group->rings);
+    free(group->shards);
+}
+
+bool tachy_shards_run(const struct tachy_shard_config *config) {
+    assert(config != NULL);
+    assert(config->shard_count > 0);
+    assert(config->main != NULL);
+
+    size_t count = config->shard_count;
+    size_t capacity = (config->ring_capacity > 0) ? config->ring_capacity : RING_DEFAULT_CAPACITY;
+    struct shard_group group = {
+        .config = config,
+        .count = count,
+        .shards = calloc(count, sizeof(struct shard)),
+        .rings = calloc(count * count, sizeof(struct shard_ring *)),
+        .start_lock = PTHREAD_MUTEX_INITIALIZER,
+        .start_cond = PTHREAD_COND_INITIALIZER,
+        .start = SHARD_START_WAIT,
+    };
+    if (group.shards == NULL || group.rings == NULL) {
+        group_free(&group, 0);
+        return false;
+    }
+
+    for (size_t i = 0; i < count * count; i++) {
+        group.rings[i] = ring_new(capacity);
+        if (group.rings[i] == NULL) {
+            group_free(&group, i);
+            return false;
+        }
+    }
+
+    pthread_barrier_init(&group.barrier, NULL, (unsigned) count);
+    size_t started = 0;
+    for (; started < count; started++) {
+        struct shard *shard = &group.shards[started];
+        atomic_init(&shard->waiter, NULL);
+        shard->group = &group;
+        shard->id = started;
+        if (signal_blocked_thread_create(&shard->thread, shard_thread, shard) != 0) {
+            break;
+        }
+    }
+
+    bool ok = started == count;
+    signal_start(&group, ok ? SHARD_START_GO : SHARD_START_CANCEL);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(group.shards[i].thread, NULL);
+        ok &= !group.shards[i].init_failed;
+    }
+
+    pthread_barrier_destroy(&group.barrier);
+    group_free(&group, count * count);
+    return ok;
+}
+
+size_t tachy_shard_id(void) {
+    assert(cur_shard != NULL);
+    return cur_shard->id;
+}
+
+size_t tachy_shard_count(void) {
+    assert(cur_shard != NULL);
+    return cur_shard->group->count;
+}
+
+bool tachy_shard_send(size_t shard_id, void *message) {
+    assert(cur_shard != NULL);
+    assert(shard_id < cur_shard->group->count);
+
+    struct shard_group *group = cur_shard->group;
+    struct shard *to = &group->shards[shard_id];
+    if (!ring_push(ring_between(group, cur_shard->id, shard_id), message)) {
+        return false;
+    }
+
+    struct task *waiter = atomic_exchange(&to->waiter, NULL);
+    if (waiter != NULL) {
+        rt_wake_task_remote(to->rt, waiter);
+    }
+    return true;
+}
+
+struct tachy_shard_recv_handle tachy_shard_recv(void) {
+    return (struct tachy_shard_recv_handle) {.state = TACHY_FUTURE_CREATED};
+}
+
+static bool shard_register(struct shard *shard, struct task *task) {
+    struct task *expected = NULL;
+    task_ref_inc(task);
+    if (atomic_compare_exchange_strong(&shard->waiter, &expected, task)) {
+        return true;
+    }
+
+    task_ref_dec(task);
+    return expected == task;
+}
+
+static void shard_unregister(struct shard *shard, struct task *task) {
+    struct task *expected = task;
+    if (atomic_compare_exchange_strong(&shard->waiter, &expected, NULL)) {
+        task_ref_dec(task);
+    }
+}
+
+enum tachy_poll tachy_shard_recv_poll(struct tachy_shard_recv_handle *handle, void **output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+    assert(cur_shard != NULL);
+
+    if (rt_dropping()) {
+        if (handle->state == TACHY_SHARD_RECV_REGISTERED) {
+            shard_unregister(cur_shard, rt_cur_task());
+            handle->state = TACHY_FUTURE_CREATED;
+        }
+        return TACHY_POLL_PENDING;
+    }
+
+    if (handle->state == TACHY_SHARD_RECV_COMPLETED || handle->state == TACHY_SHARD_BUSY_ERROR) {
+        return TACHY_POLL_READY;
+    }
+
+    struct shard_ring *ring = next_ready_ring(cur_shard);
+    if (ring == NULL) {
+        if (!shard_register(cur_shard, rt_cur_task())) {
+            handle->state = TACHY_SHARD_BUSY_ERROR;
+            return TACHY_POLL_READY;
+        }
+
+        handle->state = TACHY_SHARD_RECV_REGISTERED;
+        ring = next_ready_ring(cur_shard);
+        if (ring == NULL) {
+            return TACHY_POLL_PENDING;
+        }
+    }
+
+    if (handle->state == TACHY_SHARD_RECV_REGISTERED) {
+        shard_unregister(cur_shard, rt_cur_task());
+    }
+
+    if (!rt_poll_proceed()) {
+        return TACHY_POLL_PENDING;
+    }
+
+    *output = ring_pop(ring);
+    handle->state = TACHY_SHARD_RECV_COMPLETED;
+    return TACHY_POLL_READY;
+}
@@ -0,0 +1,207 @@
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+#include "../include/io_driver.h"
+#include "../include/runtime.h"
+#include "../include/signal_driver.h"
+#include "../include/tachy.h"
+#include "../include/task.h"
+
+static void waiters_push(struct signal_driver *driver, struct signal_entry *entry) {
+    struct signal_entry **head = &driver->waiters[entry->signo];
+    entry->prev = NULL;
+    entry->next = *head;
+    if (*head != NULL) {
+        (*head)->prev = entry;
+    }
+    *head = entry;
+}
+
+static void waiters_remove(struct signal_driver *driver, struct signal_entry *entry) {
+    if (entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    } else {
+        driver->waiters[entry->signo] = entry->next;
+    }
+
+    if (entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    }
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+static void fire(struct signal_driver *driver, int signo) {
+    struct signal_entry *entry = driver->waiters[signo];
+    if (entry == NULL) {
+        driver->pending[signo]++;
+        return;
+    }
+
+    driver->waiters[signo] = NULL;
+    while (entry != NULL) {
+        struct signal_entry *next = entry->next;
+        entry->prev = NULL;
+        entry->next = NULL;
+        entry->fired = true;
+        if (!task_complete(entry->task)) {
+            rt_wake_task(entry->task);
+        }
+        entry = next;
+    }
+}
+
+static void on_signal(struct tachy_io *io, TACHY_UNUSED uint32_t events) {
+    struct signal_driver *driver = rt_signal_driver();
+    struct signalfd_siginfo info;
+    while (1) {
+        ssize_t n = read(io->fd, &info, sizeof(info));
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n != sizeof(info)) {
+            break;
+        }
+
+        if (info.ssi_signo < NSIG) {
+            fire(driver, (int) info.ssi_signo);
+        }
+    }
+}
+
+static bool watch(struct signal_driver *driver, int signo) {
+    if (driver->io != NULL && sigismember(&driver->mask, signo)) {
+        return true;
+    }
+
+    if (driver->io == NULL) {
+        sigemptyset(&driver->mask);
+    }
+
+    sigset_t mask = driver->mask;
+    sigaddset(&mask, signo);
+    sigset_t block;
+    sigemptyset(&block);
+    sigaddset(&block, signo);
+    if (pthread_sigmask(SIG_BLOCK, &block, NULL) != 0) {
+        return false;
+    }
+
+    int fd = signalfd((driver->io != NULL) ? driver->io->fd : -1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+
+    if (driver->io == NULL) {
+        driver->io = io_register(fd, on_signal);
+        if (driver->io == NULL) {
+            close(fd);
+            return false;
+        }
+    }
+
+    driver->mask = mask;
+    return true;
+}
+
+void signal_driver_destroy(struct signal_driver *driver) {
+    assert(driver != NULL);
+
+    if (driver->io != NULL) {
+        int fd = driver->io->fd;
+        tachy_io_deregister(driver->io);
+        close(fd);
+        driver->io = NULL;
+    }
+    memset(driver->pending, 0, sizeof(driver->pending));
+}
+
+struct tachy_signal_handle tachy_signal(int signo) {
+    assert(signo > 0 && signo < NSIG);
+
+    struct signal_driver *driver = rt_signal_driver();
+    if (!watch(driver, signo)) {
+        return (struct tachy_signal_handle) {.entry = NULL, .state = TACHY_SYSTEM_ERROR};
+    }
+
+    struct signal_entry *entry = malloc(sizeof(struct signal_entry));
+    if (entry == NULL) {
+        return (struct tachy_signal_handle) {.entry = NULL, .state = TACHY_OUT_OF_MEMORY_ERROR};
+    }
+
+    // A signal that arrived while nobody was waiting satisfies the next waiter.
+    bool pending = driver->pending[signo] > 0;
+    struct task *task = rt_cur_task();
+    task_ref_inc(task);
+    *entry = (struct signal_entry) {
+        .prev = NULL,
+        .next = NULL,
+        .task = task,
+        .signo = signo,
+        .fired = pending,
+    };
+    if (pending) {
+        driver->pending[signo]--;
+    } else {
+        waiters_push(driver, entry);
+    }
+    return (struct tachy_signal_handle) {.entry = entry, .state = TACHY_SIGNAL_REGISTERED};
+}
+
+static void entry_free(struct signal_entry *entry) {
+    task_ref_dec(entry->task);
+    free(entry);
+}
+
+enum tachy_poll tachy_signal_poll(struct tachy_signal_handle *handle, TACHY_UNUSED void *output) {
+    assert(handle != NULL);
+    assert(handle->state != TACHY_SIGNAL_CANCELED);
+
+    if (rt_dropping()) {
+        if (handle->state == TACHY_SIGNAL_REGISTERED) {
+            tachy_signal_cancel(handle);
+        }
+        return TACHY_POLL_PENDING;
+    }
+
+    if (handle->state == TACHY_SIGNAL_REGISTERED) {
+        if (!handle->entry->fired || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        entry_free(handle->entry);
+        handle->entry = NULL;
+        handle->state = TACHY_SIGNAL_COMPLETED;
+    }
+    return TACHY_POLL_READY;
+}
+
+void tachy_signal_cancel(struct tachy_signal_handle *handle) {
+    assert(handle != NULL);
+    assert(handle->state != TACHY_SIGNAL_CANCELED);
+    assert(handle->state != TACHY_SIGNAL_COMPLETED);
+
+    if (!handle->entry->fired) {
+        waiters_remove(rt_signal_driver(), handle->entry);
+    }
+
+    entry_free(handle->entry);
+    handle->entry = NULL;
+    handle->state = TACHY_SIGNAL_CANCELED;
+}
+
+int signal_blocked_thread_create(pthread_t *thread, void *(*start)(void *), void *arg) {
+    sigset_t all;
+    sigset_t old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    int err = pthread_create(thread, NULL, start, arg);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return err;
+}
@@ -19,6 +19,13 @@ enum tachy_poll tachy_sleep_poll(struct tachy_sleep_handle *handle, TACHY_UNUSED
     assert(handle != NULL);
     assert(handle->state != TACHY_SLEEP_CANCELED);
 
+    if (rt_dropping()) {
+        if (handle->state == TACHY_FUTURE_CREATED || handle->state == TACHY_SLEEP_REGISTERED) {
+            tachy_sleep_cancel(handle);
+        }
+        return TACHY_POLL_PENDING;
+    }
+
     if (handle->state == TACHY_FUTURE_CREATED) {
         handle->state = TACHY_SLEEP_REGISTERED;
         struct time_driver *driver = rt_time_driver();
@@ -26,7 +33,7 @@ enum tachy_poll tachy_sleep_poll(struct tachy_sleep_handle *handle, TACHY_UNUSED
     }
 
     if (handle->state == TACHY_SLEEP_REGISTERED) {
-        if (!time_entry_fired(handle->entry)) {
+        if (!time_entry_fired(handle->entry) || !rt_poll_proceed()) {
             return TACHY_POLL_PENDING;
         }
 
@@ -0,0 +1,62 @@
+#include <assert.h>
+
+#include "../include/runtime.h"
+#include "../include/tachy.h"
+
+struct tachy_stream_next_handle tachy__stream_next(void *stream, tachy_poll_fn poll_fn, void *items,
+                                                   size_t item_size_bytes, size_t max)
+{
+    assert(stream != NULL);
+    assert(poll_fn != NULL);
+    assert(items != NULL);
+    assert(max > 0);
+
+    return (struct tachy_stream_next_handle) {
+        .stream = stream,
+        .poll_fn = poll_fn,
+        .items = items,
+        .item_size_bytes = item_size_bytes,
+        .max = max,
+        .ended = false,
+        .state = TACHY_FUTURE_CREATED,
+    };
+}
+
+enum tachy_poll tachy_stream_next_poll(struct tachy_stream_next_handle *handle, size_t *output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    if (rt_dropping()) {
+        if (handle->state == TACHY_FUTURE_CREATED) {
+            handle->poll_fn(handle->stream, handle->items);
+        }
+        return TACHY_POLL_PENDING;
+    }
+
+    if (handle->state == TACHY_FUTURE_CREATED) {
+        if (!rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        size_t count = 0;
+        while (count < handle->max) {
+            void *item = handle->items + (count * handle->item_size_bytes);
+            enum tachy_poll poll_out = handle->poll_fn(handle->stream, item);
+            if (poll_out == TACHY_POLL_ITEM) {
+                count++;
+                continue;
+            }
+
+            if (poll_out == TACHY_POLL_PENDING && count == 0) {
+                return TACHY_POLL_PENDING;
+            }
+
+            handle->ended = (poll_out == TACHY_POLL_READY);
+            break;
+        }
+
+        *output = count;
+        handle->state = TACHY_IO_COMPLETED;
+    }
+    return TACHY_POLL_READY;
+}
@@ -1,9 +1,14 @@
 #include <assert.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "../include/bufio.h"
+#include "../include/probes.h"
 #include "../include/runtime.h"
+#include "../include/scope.h"
 #include "../include/task.h"
+#include "../include/watchdog.h"
 
 static bool is_runnable(struct task *task) {
     return (task->state & TASK_RUNNABLE) != 0;
@@ -21,6 +26,18 @@ static bool is_complete(struct task *task) {
     return (task->state & TASK_COMPLETE) != 0;
 }
 
+static bool is_deferred(struct task *task) {
+    return (task->state & TASK_DEFERRED) != 0;
+}
+
+static bool is_started(struct task *task) {
+    return (task->state & TASK_STARTED) != 0;
+}
+
+static bool is_canceled(struct task *task) {
+    return (task->state & TASK_CANCELED) != 0;
+}
+
 static void transition_to_runnable(struct task *task) {
     assert(is_waiting(task));
     task->state &= ~TASK_WAITING;
@@ -50,51 +67,137 @@ static void *future(struct task *task) {
     return task->future_or_output;
 }
 
-struct task *task_new(void *future, tachy_poll_fn poll_fn,
-                      size_t future_size_bytes, size_t output_size_bytes)
-{
-    assert(future != NULL);
+size_t task_alloc_size(size_t future_size_bytes, size_t output_size_bytes) {
+    return sizeof(struct task) + TACHY_MAX(future_size_bytes, output_size_bytes);
+}
+
+static size_t block_stride(size_t future_size_bytes, size_t output_size_bytes) {
+    size_t stride = task_alloc_size(future_size_bytes, output_size_bytes);
+    return (stride + TASK_ALIGN - 1) & ~((size_t) TASK_ALIGN - 1);
+}
+
+size_t task_block_alloc_size(size_t count, size_t future_size_bytes, size_t output_size_bytes) {
+    size_t stride = block_stride(future_size_bytes, output_size_bytes);
+    if (count > INT_MAX || count > (SIZE_MAX - sizeof(struct task_block)) / stride) {
+        return SIZE_MAX;
+    }
+    return sizeof(struct task_block) + (count * stride);
+}
+
+struct task *task_alloc(tachy_poll_fn poll_fn, size_t future_size_bytes, size_t output_size_bytes) {
     assert(poll_fn != NULL);
     assert(future_size_bytes > 0);
 
-    size_t future_or_output_bytes = TACHY_MAX(future_size_bytes, output_size_bytes);
-    struct task *task = malloc(sizeof(struct task) + future_or_output_bytes);
+    size_t size = task_alloc_size(future_size_bytes, output_size_bytes);
+    struct task *task = malloc(size);
     if (task == NULL) {
         return NULL;
     }
+    rt_task_acquire(1, size);
 
     *task = (struct task) {
         .next = NULL,
         .poll_fn = poll_fn,
         .ref_count = 1,
         .state = TASK_RUNNABLE,
+        .priority = TACHY_PRIORITY_NORMAL,
         .consumer = NULL,
+        .block = NULL,
+        .remote_next = NULL,
+        .remote_wakes = 0,
+        .scope_link = NULL,
+        .leaf_poll_fn = NULL,
         .future_size_bytes = future_size_bytes,
         .output_size_bytes = output_size_bytes,
     };
+    TACHY_PROBE2(task_new, task, TACHY_PROBE_FN(poll_fn));
+    return task;
+}
+
+struct task *task_new(void *future, tachy_poll_fn poll_fn,
+                      size_t future_size_bytes, size_t output_size_bytes)
+{
+    assert(future != NULL);
+
+    struct task *task = task_alloc(poll_fn, future_size_bytes, output_size_bytes);
+    if (task == NULL) {
+        return NULL;
+    }
+
     memcpy(task->future_or_output, future, future_size_bytes);
     return task;
 }
 
+static enum tachy_poll poll_leaf(struct task *task) {
+    tachy_poll_fn poll_fn = task->leaf_poll_fn;
+    task->leaf_poll_fn = NULL;
+    if (poll_fn(task->leaf_future, task->leaf_output) == TACHY_POLL_READY) {
+        return TACHY_POLL_READY;
+    }
+
+    if (task->leaf_poll_fn == NULL) {
+        task->leaf_poll_fn = poll_fn;
+    }
+    return TACHY_POLL_PENDING;
+}
+
+static void finish(struct task *task) {
+    task->leaf_poll_fn = NULL;
+    rt_release_reservation(task);
+    if (task->consumer != NULL) {
+        rt_wake_task_next(task->consumer);
+    }
+    scope_task_finished(task);
+    if (rt_bufwriter_queue()->head != NULL) {
+        bufwriter_unschedule_range(rt_bufwriter_queue(), task->future_or_output,
+                                   TACHY_MAX(task->future_size_bytes, task->output_size_bytes));
+    }
+    transition_to_complete(task);
+    task_ref_dec(task);
+}
+
+static void drop(struct task *task, void *output) {
+    if (is_started(task)) {
+        rt_set_dropping(true);
+        task->poll_fn(future(task), output);
+        rt_set_dropping(false);
+    }
+    finish(task);
+}
+
 enum tachy_poll task_poll(struct task *task, void *output) {
     assert(task != NULL);
     assert(task->poll_fn != NULL);
     assert(task->future_or_output != NULL);
 
     transition_to_running(task);
+    task->budget = TASK_POLL_BUDGET;
+    tachy_poll_fn poll_fn = task->poll_fn;
+    TACHY_PROBE2(task_poll_start, task, TACHY_PROBE_FN(poll_fn));
+    struct watchdog *watchdog = rt_watchdog();
+    watchdog_poll_begin(watchdog, poll_fn);
+
+    enum tachy_poll poll_out = TACHY_POLL_PENDING;
+    if (!is_canceled(task)) {
+        task->state |= TASK_STARTED;
+        if (task->leaf_poll_fn == NULL || poll_leaf(task) == TACHY_POLL_READY) {
+            poll_out = poll_fn(future(task), output);
+            assert(poll_out != TACHY_POLL_ITEM);
+        }
+    }
 
-    void *fut = future(task);
-    enum tachy_poll poll_out = task->poll_fn(fut, output);
-    if (poll_out == TACHY_POLL_PENDING) {
+    if (poll_out == TACHY_POLL_PENDING && is_canceled(task)) {
+        drop(task, output);
+        poll_out = TACHY_POLL_READY;
+    } else if (poll_out == TACHY_POLL_PENDING) {
         transition_to_waiting(task);
     } else {
-        if (task->consumer != NULL) {
-            rt_wake_task(task->consumer);
-        }
-        transition_to_complete(task);
-        task_ref_dec(task);
+        task->state &= ~TASK_CANCELED;
+        finish(task);
     }
 
+    watchdog_poll_end(watchdog);
+    TACHY_PROBE3(task_poll_end, task, TACHY_PROBE_FN(poll_fn), (int) poll_out);
     return poll_out;
 }
 
@@ -120,6 +223,10 @@ bool task_try_copy_output(struct task *task, void *output) {
         return false;
     }
 
+    if (is_canceled(task)) {
+        return true;
+    }
+
     void *out = task_output(task);
     memcpy(output, out, task->output_size_bytes);
     return true;
@@ -136,8 +243,24 @@ void task_ref_dec(struct task *task) {
     assert(task->ref_count > 0);
 
     task->ref_count--;
-    if (task->ref_count < 1) {
+    if (task->ref_count >= 1) {
+        return;
+    }
+
+    struct task_block *block = task->block;
+    if (block == NULL) {
+        size_t size = task_alloc_size(task->future_size_bytes, task->output_size_bytes);
         free(task);
+        rt_task_release(1, size);
+        return;
+    }
+
+    block->ref_count--;
+    if (block->ref_count < 1) {
+        size_t count = block->task_count;
+        size_t size = sizeof(struct task_block) + (count * block->task_stride);
+        free(block);
+        rt_task_release(count, size);
     }
 }
 
@@ -146,16 +269,128 @@ bool task_runnable(struct task *task) {
     return is_runnable(task);
 }
 
+bool task_complete(struct task *task) {
+    assert(task != NULL);
+    return is_complete(task);
+}
+
+bool task_deferred(struct task *task) {
+    assert(task != NULL);
+    return is_deferred(task);
+}
+
+bool task_canceled(struct task *task) {
+    assert(task != NULL);
+    return is_canceled(task);
+}
+
+void task_cancel(struct task *task) {
+    assert(task != NULL);
+
+    if (is_complete(task) || is_canceled(task)) {
+        return;
+    }
+
+    task->state |= TASK_CANCELED;
+    if (is_waiting(task) && !is_deferred(task)) {
+        rt_wake_task(task);
+    }
+}
+
 void task_make_runnable(struct task *task) {
     assert(task != NULL);
     transition_to_runnable(task);
 }
 
+void task_set_deferred(struct task *task, bool deferred) {
+    assert(task != NULL);
+
+    if (deferred) {
+        task->state |= TASK_DEFERRED;
+    } else {
+        task->state &= ~TASK_DEFERRED;
+    }
+}
+
+bool task_consume_budget(struct task *task) {
+    assert(task != NULL);
+    assert(is_running(task));
+
+    if (task->budget <= 0) {
+        return false;
+    }
+
+    task->budget--;
+    return true;
+}
+
+void *task_future(struct task *task) {
+    assert(task != NULL);
+    return future(task);
+}
+
 void *task_output(struct task *task) {
     assert(task != NULL);
     return (task->output_size_bytes > 0) ? task->future_or_output : NULL;
 }
 
+struct task_block *task_block_new(void *futures, size_t count, tachy_poll_fn poll_fn,
+                                  size_t future_size_bytes, size_t output_size_bytes)
+{
+    assert(futures != NULL);
+    assert(count > 0);
+    assert(poll_fn != NULL);
+    assert(future_size_bytes > 0);
+
+    size_t size = task_block_alloc_size(count, future_size_bytes, output_size_bytes);
+    if (size == SIZE_MAX) {
+        return NULL;
+    }
+
+    size_t stride = block_stride(future_size_bytes, output_size_bytes);
+    struct task_block *block = malloc(size);
+    if (block == NULL) {
+        return NULL;
+    }
+    rt_task_acquire(count, size);
+
+    *block = (struct task_block) {
+        .ref_count = (int) count,
+        .task_count = count,
+        .task_stride = stride,
+    };
+
+    char *future = futures;
+    for (size_t i = 0; i < count; i++) {
+        struct task *task = task_block_at(block, i);
+        *task = (struct task) {
+            .next = (i + 1 < count) ? task_block_at(block, i + 1) : NULL,
+            .poll_fn = poll_fn,
+            .ref_count = 1,
+            .state = TASK_RUNNABLE,
+            .priority = TACHY_PRIORITY_NORMAL,
+            .consumer = NULL,
+            .block = block,
+            .remote_next = NULL,
+            .remote_wakes = 0,
+            .scope_link = NULL,
+            .leaf_poll_fn = NULL,
+            .future_size_bytes = future_size_bytes,
+            .output_size_bytes = output_size_bytes,
+        };
+        memcpy(task->future_or_output, future, future_size_bytes);
+        future += future_size_bytes;
+        TACHY_PROBE2(task_new, task, TACHY_PROBE_FN(poll_fn));
+    }
+    return block;
+}
+
+struct task *task_block_at(struct task_block *block, size_t idx) {
+    assert(block != NULL);
+    assert(idx < block->task_count);
+    return (struct task *) (block->tasks + (idx * block->task_stride));
+}
+
 bool task_list_empty(struct task_list *list) {
     assert(list != NULL);
     return list->head == NULL;
@@ -169,6 +404,15 @@ void task_list_push_front(struct task_list *list, struct task *task) {
     list->head = task;
 }
 
+void task_list_splice_front(struct task_list *list, struct task *head, struct task *tail) {
+    assert(list != NULL);
+    assert(head != NULL);
+    assert(tail != NULL);
+
+    tail->next = list->head;
+    list->head = head;
+}
+
 struct task *task_list_pop_front(struct task_list *list) {
     assert(list != NULL);
 
@@ -179,3 +423,17 @@ struct task *task_list_pop_front(struct task_list *list) {
     }
     return task;
 }
+
+enum tachy_poll tachy__await_nested(tachy_poll_fn poll_fn, void *future, void *output) {
+    assert(poll_fn != NULL);
+    assert(future != NULL);
+
+    enum tachy_poll poll_out = poll_fn(future, output);
+    struct task *task = rt_cur_task();
+    if (poll_out == TACHY_POLL_PENDING && task->leaf_poll_fn == NULL) {
+        task->leaf_poll_fn = poll_fn;
+        task->leaf_future = future;
+        task->leaf_output = output;
+    }
+    return poll_out;
+}
@@ -2,6 +2,7 @@
 #include <stddef.h>
 #include <stdlib.h>
 
+#include "../include/probes.h"
 #include "../include/runtime.h"
 #include "../include/time_driver.h"
 
@@ -74,6 +75,7 @@ static int slot_next_occupied(int level, uint64_t now, uint64_t slot_bitmap) {
 void time_insert_timeout(struct time_driver *driver, struct time_entry *entry) {
     assert(driver != NULL);
     assert(entry != NULL);
+    TACHY_PROBE2(timer_insert, entry->task, entry->deadline);
 
     if (driver->elapsed >= entry->deadline) {
         time_entry_make_fired(entry);
@@ -85,6 +87,7 @@ void time_insert_timeout(struct time_driver *driver, struct time_entry *entry) {
     int s = slot_for(l, entry->deadline);
 
     struct time_wheel_level *level = &driver->wheel_levels[l];
+    entry->level = l;
     time_entry_list_push_front(&level->slots[s], entry);
     driver->active_slot_bitmap[l] |= BIT_SET(s);
 }
@@ -94,8 +97,7 @@ void time_remove_timeout(struct time_driver *driver, struct time_entry *entry) {
     assert(entry != NULL);
 
     if (!time_entry_fired(entry)) {
-        uint64_t timeout = entry->deadline - driver->elapsed;
-        int l = level_for(timeout);
+        int l = entry->level;
         int s = slot_for(l, entry->deadline);
 
         struct time_wheel_level *level = &driver->wheel_levels[l];
@@ -136,6 +138,7 @@ static void slot_process_expiration(struct time_driver *driver,
 }
 
 void time_process_at(struct time_driver *driver, uint64_t now) {
+    TACHY_PROBE2(timer_process, driver->elapsed, now);
     for (int level = 0; level < TIME_WHEEL_LEVELS; level++) {
         uint64_t slot_res = slot_resolution(level);
         uint64_t level_res = level_resolution(slot_res);
@@ -254,6 +257,24 @@ static void test_slot_process_expiration(void) {
     assert(task2.state = TASK_WAITING);
 }
 
+static void test_remove_timeout(void) {
+    struct time_driver driver = {0};
+    struct task task = {.state = TASK_WAITING};
+    struct time_entry e1 = {.task = &task, .deadline = 5000};
+    struct time_entry e2 = {.task = &task, .deadline = 5000};
+
+    time_insert_timeout(&driver, &e1);
+    time_insert_timeout(&driver, &e2);
+    driver.elapsed = 4990;
+
+    time_remove_timeout(&driver, &e2);
+    assert(driver.wheel_levels[2].slots[1].head == &e1);
+    assert(driver.active_slot_bitmap[2] == BIT_SET(1));
+
+    time_remove_timeout(&driver, &e1);
+    assert(driver.active_slot_bitmap[2] == 0);
+}
+
 void time_driver_tests(void) {
     test_clz64();
     printf("✅ Passed test_clz64()\n");
@@ -273,5 +294,7 @@ void time_driver_tests(void) {
     printf("✅ Passed test_slot_next_occupied()\n");
     test_slot_process_expiration();
     printf("✅ Passed test_slot_process_expiration()\n");
+    test_remove_timeout();
+    printf("✅ Passed test_remove_timeout()\n");
 }
 #endif
@@ -19,7 +19,8 @@ struct time_entry *time_entry_new(struct task *task, uint64_t deadline) {
         .prev = NULL,
         .next = NULL,
         .task = task,
-        .deadline = deadline
+        .deadline = deadline,
+        .level = 0
     };
     return entry;
 }
@@ -50,6 +51,7 @@ void time_entry_list_push_front(struct time_entry_list *list, struct time_entry
     assert(entry != NULL);
 
     struct time_entry *cur_head = list->head;
+    entry->prev = NULL;
     entry->next = cur_head;
     if (cur_head != NULL) {
         cur_head->prev = entry;
@@ -87,8 +89,7 @@ void time_entry_list_remove(struct time_entry_list *list, struct time_entry *ent
     assert(entry_in_list(list, entry));
 
     if (list->head == entry) {
-        list->head = NULL;
-        return;
+        list->head = entry->next;
     }
 
     if (entry->prev != NULL) {
@@ -98,4 +99,6 @@ void time_entry_list_remove(struct time_entry_list *list, struct time_entry *ent
     if (entry->next != NULL) {
         entry->next->prev = entry->prev;
     }
+    entry->prev = NULL;
+    entry->next = NULL;
 }
@@ -0,0 +1,126 @@
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "../include/io_driver.h"
+#include "../include/runtime.h"
+#include "../include/tachy.h"
+
+struct tachy_udp_batch_handle tachy_udp_recv_batch(struct tachy_io *io, struct mmsghdr *msgs, unsigned int count) {
+    assert(io != NULL);
+    assert(msgs != NULL);
+    assert(count > 0);
+    return (struct tachy_udp_batch_handle) {.io = io, .msgs = msgs, .count = count, .done = 0, .state = TACHY_FUTURE_CREATED};
+}
+
+struct tachy_udp_batch_handle tachy_udp_send_batch(struct tachy_io *io, struct mmsghdr *msgs, unsigned int count) {
+    assert(io != NULL);
+    assert(msgs != NULL);
+    assert(count > 0);
+    return (struct tachy_udp_batch_handle) {.io = io, .msgs = msgs, .count = count, .done = 0, .state = TACHY_FUTURE_CREATED};
+}
+
+enum tachy_poll tachy_udp_recv_batch_poll(struct tachy_udp_batch_handle *handle, int64_t *output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    while (handle->state == TACHY_FUTURE_CREATED) {
+        if (!io_poll_ready(handle->io, IO_READABLE) || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        int n = recvmmsg(handle->io->fd, handle->msgs, handle->count, MSG_DONTWAIT, NULL);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            io_clear_readiness(handle->io, IO_READABLE);
+            continue;
+        }
+
+        *output = (n == -1) ? -errno : n;
+        handle->state = TACHY_IO_COMPLETED;
+    }
+    return TACHY_POLL_READY;
+}
+
+enum tachy_poll tachy_udp_send_batch_poll(struct tachy_udp_batch_handle *handle, int64_t *output) {
+    assert(handle != NULL);
+    assert(output != NULL);
+
+    if (handle->state == TACHY_IO_COMPLETED) {
+        return TACHY_POLL_READY;
+    }
+
+    while (handle->done < handle->count) {
+        if (!io_poll_ready(handle->io, IO_WRITABLE) || !rt_poll_proceed()) {
+            return TACHY_POLL_PENDING;
+        }
+
+        int n = sendmmsg(handle->io->fd, handle->msgs + handle->done, handle->count - handle->done, MSG_DONTWAIT);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            io_clear_readiness(handle->io, IO_WRITABLE);
+            continue;
+        }
+
+        if (n == -1) {
+            *output = (handle->done > 0) ? (int64_t) handle->done : -errno;
+            handle->state = TACHY_IO_COMPLETED;
+            return TACHY_POLL_READY;
+        }
+        handle->done += (unsigned int) n;
+    }
+
+    *output = handle->done;
+    handle->state = TACHY_IO_COMPLETED;
+    return TACHY_POLL_READY;
+}
+
+bool tachy_udp_enable_gro(struct tachy_io *io) {
+    assert(io != NULL);
+
+#ifdef UDP_GRO
+    int one = 1;
+    return setsockopt(io->fd, SOL_UDP, UDP_GRO, &one, sizeof(one)) == 0;
+#else
+    return false;
+#endif
+}
+
+bool tachy_udp_set_gso_segment(struct tachy_io *io, uint16_t segment_size) {
+    assert(io != NULL);
+
+#ifdef UDP_SEGMENT
+    int size = segment_size;
+    return setsockopt(io->fd, SOL_UDP, UDP_SEGMENT, &size, sizeof(size)) == 0;
+#else
+    (void) segment_size;
+    return false;
+#endif
+}
+
+size_t tachy_udp_gro_segment_size(const struct mmsghdr *msg) {
+    assert(msg != NULL);
+
+#ifdef UDP_GRO
+    const struct msghdr *hdr = &msg->msg_hdr;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(hdr); cmsg != NULL; cmsg = CMSG_NXTHDR((struct msghdr *) hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int size;
+            memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+            return (size_t) size;
+        }
+    }
+#endif
+    return msg->msg_len;
+}
@@ -0,0 +1,215 @@
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/clock.h"
+#include "../include/runtime.h"
+#include "../include/signal_driver.h"
+#include "../include/watchdog.h"
+
+static const char *symbol_for(tachy_poll_fn poll_fn) {
+    Dl_info info;
+    void *addr = (void *) (uintptr_t) poll_fn;
+    if (dladdr(addr, &info) == 0 || info.dli_saddr != addr) {
+        return NULL;
+    }
+    return info.dli_sname;
+}
+
+static void report_stderr(const struct tachy_long_poll *poll, TACHY_UNUSED void *arg) {
+    fprintf(stderr, "tachy: poll of %s (%p) has run for %.3fms",
+            (poll->symbol != NULL) ? poll->symbol : "?", (void *) (uintptr_t) poll->poll_fn,
+            (double) poll->elapsed_ns / 1e6);
+    if (poll->label_file != NULL) {
+#if TACHY_USE_COMPUTED_GOTO
+        fprintf(stderr, ", resumed at %s:goto@%p", poll->label_file, (void *) poll->label);
+#else
+        fprintf(stderr, ", resumed at %s:%ld", poll->label_file, (long) poll->label);
+#endif
+    }
+    fprintf(stderr, "\n");
+}
+
+static void check(struct watchdog *watchdog, uint64_t *reported_start) {
+    uint64_t start = atomic_load_explicit(&watchdog->poll_start_ns, memory_order_acquire);
+    if (start == 0 || start == *reported_start) {
+        return;
+    }
+
+    uint64_t elapsed = clock_precise_ns() - start;
+    if (elapsed < watchdog->threshold_ns) {
+        return;
+    }
+
+    struct tachy_long_poll poll = {
+        .poll_fn = atomic_load_explicit(&watchdog->poll_fn, memory_order_relaxed),
+        .label_file = atomic_load_explicit(&watchdog->label_file, memory_order_relaxed),
+        .label = atomic_load_explicit(&watchdog->label, memory_order_relaxed),
+        .elapsed_ns = elapsed,
+    };
+    if (atomic_load_explicit(&watchdog->poll_start_ns, memory_order_acquire) != start) {
+        return;
+    }
+
+    poll.symbol = symbol_for(poll.poll_fn);
+    watchdog->report_fn(&poll, watchdog->report_arg);
+    *reported_start = start;
+}
+
+static void *watchdog_thread(void *arg) {
+    struct watchdog *watchdog = arg;
+    uint64_t interval_ns = watchdog->threshold_ns / 2;
+    struct timespec interval = {
+        .tv_sec = (time_t) (interval_ns / 1000000000),
+        .tv_nsec = (long) (interval_ns % 1000000000),
+    };
+
+    uint64_t reported_start = 0;
+    while (!atomic_load(&watchdog->stop)) {
+        nanosleep(&interval, NULL);
+        check(watchdog, &reported_start);
+    }
+    return NULL;
+}
+
+bool watchdog_init(struct watchdog *watchdog, const struct tachy_config *config) {
+    assert(watchdog != NULL);
+    assert(config != NULL);
+
+    *watchdog = (struct watchdog) {
+        .enabled = config->watchdog_threshold_us != 0,
+        .threshold_ns = US_TO_NS(config->watchdog_threshold_us),
+        .report_fn = (config->watchdog_fn != NULL) ? config->watchdog_fn : report_stderr,
+        .report_arg = config->watchdog_arg,
+    };
+    atomic_init(&watchdog->stop, false);
+    atomic_init(&watchdog->poll_start_ns, 0);
+    atomic_init(&watchdog->poll_fn, NULL);
+    atomic_init(&watchdog->label_file, NULL);
+    atomic_init(&watchdog->label, 0);
+    if (!watchdog->enabled) {
+        return true;
+    }
+
+    watchdog->histograms = calloc(WATCHDOG_HISTOGRAM_SLOTS, sizeof(struct tachy_poll_histogram));
+    if (watchdog->histograms == NULL) {
+        return false;
+    }
+
+    if (signal_blocked_thread_create(&watchdog->thread, watchdog_thread, watchdog) != 0) {
+        free(watchdog->histograms);
+        watchdog->histograms = NULL;
+        return false;
+    }
+    watchdog->running = true;
+    return true;
+}
+
+void watchdog_destroy(struct watchdog *watchdog) {
+    assert(watchdog != NULL);
+
+    if (watchdog->running) {
+        atomic_store(&watchdog->stop, true);
+        pthread_join(watchdog->thread, NULL);
+        watchdog->running = false;
+    }
+    free(watchdog->histograms);
+    watchdog->histograms = NULL;
+    watchdog->enabled = false;
+}
+
+void watchdog_poll_begin(struct watchdog *watchdog, tachy_poll_fn poll_fn) {
+    if (!watchdog->enabled) {
+        return;
+    }
+
+    atomic_store_explicit(&watchdog->poll_fn, poll_fn, memory_order_relaxed);
+    atomic_store_explicit(&watchdog->label_file, NULL, memory_order_relaxed);
+    atomic_store_explicit(&watchdog->label, 0, memory_order_relaxed);
+    atomic_store_explicit(&watchdog->poll_start_ns, clock_precise_ns(), memory_order_release);
+}
+
+static struct tachy_poll_histogram *histogram_for(struct watchdog *watchdog, tachy_poll_fn poll_fn) {
+    uintptr_t hash = (uintptr_t) poll_fn;
+    hash = (hash >> 4) * 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < WATCHDOG_HISTOGRAM_SLOTS; i++) {
+        struct tachy_poll_histogram *histogram =
+            &watchdog->histograms[(hash + i) & (WATCHDOG_HISTOGRAM_SLOTS - 1)];
+        if (histogram->poll_fn == poll_fn) {
+            return histogram;
+        }
+
+        if (histogram->poll_fn == NULL) {
+            histogram->poll_fn = poll_fn;
+            return histogram;
+        }
+    }
+    return NULL;
+}
+
+static int bucket_for(uint64_t ns) {
+    int bucket = 63 - __builtin_clzll(ns | 1);
+    return TACHY_MIN(bucket, TACHY_POLL_HISTOGRAM_BUCKETS - 1);
+}
+
+void watchdog_poll_end(struct watchdog *watchdog) {
+    if (!watchdog->enabled) {
+        return;
+    }
+
+    tachy_poll_fn poll_fn = atomic_load_explicit(&watchdog->poll_fn, memory_order_relaxed);
+    uint64_t start = atomic_load_explicit(&watchdog->poll_start_ns, memory_order_relaxed);
+    atomic_store_explicit(&watchdog->poll_start_ns, 0, memory_order_release);
+
+    uint64_t elapsed = clock_precise_ns() - start;
+    struct tachy_poll_histogram *histogram = histogram_for(watchdog, poll_fn);
+    if (histogram != NULL) {
+        histogram->count++;
+        histogram->total_ns += elapsed;
+        histogram->buckets[bucket_for(elapsed)]++;
+    }
+}
+
+size_t tachy_poll_histograms(struct tachy_poll_histogram *histograms, size_t max) {
+    struct watchdog *watchdog = rt_watchdog();
+    if (watchdog->histograms == NULL) {
+        return 0;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < WATCHDOG_HISTOGRAM_SLOTS; i++) {
+        struct tachy_poll_histogram *histogram = &watchdog->histograms[i];
+        if (histogram->poll_fn == NULL) {
+            continue;
+        }
+
+        if (count < max) {
+            histograms[count] = *histogram;
+            histograms[count].symbol = symbol_for(histogram->poll_fn);
+        }
+        count++;
+    }
+    return count;
+}
+
+void tachy_poll_histograms_reset(void) {
+    struct watchdog *watchdog = rt_watchdog();
+    if (watchdog->histograms != NULL) {
+        memset(watchdog->histograms, 0, WATCHDOG_HISTOGRAM_SLOTS * sizeof(struct tachy_poll_histogram));
+    }
+}
+
+void tachy__watch_resume(const char *file, intptr_t label) {
+    struct watchdog *watchdog = rt_watchdog();
+    if (!watchdog->enabled) {
+        return;
+    }
+
+    atomic_store_explicit(&watchdog->label_file, file, memory_order_relaxed);
+    atomic_store_explicit(&watchdog->label, label, memory_order_relaxed);
+}
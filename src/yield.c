@@ -10,6 +10,10 @@ struct tachy_yield_handle tachy_yield(void) {
 enum tachy_poll tachy_yield_poll(struct tachy_yield_handle *handle, TACHY_UNUSED void *output) {
     assert(handle != NULL);
 
+    if (rt_dropping()) {
+        return TACHY_POLL_PENDING;
+    }
+
     if (handle->state == TACHY_FUTURE_CREATED) {
         handle->state = TACHY_YIELDED;
         struct task *task = rt_cur_task();
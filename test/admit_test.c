@@ -0,0 +1,248 @@
+#include <assert.h>
+#include <stdio.h>
+
+#include "../include/tachy.h"
+
+#define HUGE_FUTURE_BYTES ((size_t) 1 << 62)
+
+struct sleeper {
+    uint64_t msecs;
+    int *done;
+    struct tachy_sleep_handle sleep;
+    tachy_state state;
+};
+
+static struct sleeper sleeper(uint64_t msecs, int *done) {
+    return (struct sleeper) {.msecs = msecs, .done = done};
+}
+
+enum tachy_poll sleeper_poll(struct sleeper *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->sleep = tachy_sleep((struct tachy_duration) {.msecs = self->msecs});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    (*self->done)++;
+    tachy_return();
+    tachy_end;
+}
+
+struct spawner {
+    int *done;
+    int *error;
+    struct tachy_sleep_handle sleep;
+    tachy_state state;
+};
+
+enum tachy_poll spawner_poll(struct spawner *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->sleep = tachy_sleep((struct tachy_duration) {.msecs = 10});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    struct sleeper child = sleeper(1, self->done);
+    *self->error = tachy_spawn_no_join(&child, (tachy_poll_fn) &sleeper_poll, 0);
+    tachy_return();
+    tachy_end;
+}
+
+struct admitter {
+    size_t count;
+    uint64_t *admitted_at;
+    struct tachy_admit_handle admit;
+    tachy_state state;
+};
+
+enum tachy_poll admitter_poll(struct admitter *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->admit = tachy_admit_n(struct sleeper, self->count, 0);
+    tachy_await(tachy_admit_poll(&self->admit, NULL));
+    *self->admitted_at = tachy_now_ms();
+    tachy_admit_cancel(&self->admit);
+    tachy_return();
+    tachy_end;
+}
+
+static void run(size_t max_tasks, void *future, tachy_poll_fn poll_fn, size_t future_size_bytes) {
+    struct tachy_config config = {.clock_mode = TACHY_CLOCK_VIRTUAL, .max_tasks = max_tasks};
+    bool initialised = tachy_init_with_config(&config);
+    assert(initialised);
+    tachy__block_on(future, poll_fn, future_size_bytes, NULL);
+    assert(tachy_task_usage().live_tasks == 0);
+    tachy_shutdown();
+}
+
+struct limit {
+    int done;
+    struct tachy_join_handle joins[3];
+    tachy_state state;
+};
+
+enum tachy_poll limit_poll(struct limit *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    for (int i = 0; i < 3; i++) {
+        struct sleeper child = sleeper(10, &self->done);
+        self->joins[i] = tachy_spawn(&child, (tachy_poll_fn) &sleeper_poll, 0);
+    }
+    assert(self->joins[0].state == TACHY_FUTURE_CREATED);
+    assert(self->joins[1].state == TACHY_FUTURE_CREATED);
+    assert(self->joins[2].state == TACHY_ADMISSION_ERROR);
+    assert(tachy_task_usage().rejected == 1);
+
+    tachy_await(tachy_join_poll(&self->joins[0], NULL));
+    tachy_await(tachy_join_poll(&self->joins[1], NULL));
+    assert(self->done == 2);
+    tachy_return();
+    tachy_end;
+}
+
+void test_limit_rejects(void) {
+    struct limit future = {0};
+    run(3, &future, (tachy_poll_fn) &limit_poll, sizeof(future));
+}
+
+struct waiter_woken {
+    int done;
+    uint64_t admitted_at;
+    int error;
+    struct tachy_join_handle join;
+    struct tachy_yield_handle yield;
+    tachy_state state;
+};
+
+enum tachy_poll waiter_woken_poll(struct waiter_woken *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    struct sleeper child = sleeper(10, &self->done);
+    int err = tachy_spawn_no_join(&child, (tachy_poll_fn) &sleeper_poll, 0);
+    assert(err == TACHY_FUTURE_CREATED);
+    struct admitter waiter = {.count = 2, .admitted_at = &self->admitted_at};
+    self->join = tachy_spawn(&waiter, (tachy_poll_fn) &admitter_poll, 0);
+    assert(self->join.state == TACHY_FUTURE_CREATED);
+
+    self->yield = tachy_yield();
+    tachy_await(tachy_yield_poll(&self->yield, NULL));
+    child = sleeper(1, &self->done);
+    self->error = tachy_spawn_no_join(&child, (tachy_poll_fn) &sleeper_poll, 0);
+    assert(self->error == TACHY_ADMISSION_ERROR);
+
+    tachy_await(tachy_join_poll(&self->join, NULL));
+    assert(self->done == 1);
+    assert(self->admitted_at == 10);
+    tachy_return();
+    tachy_end;
+}
+
+void test_waiter_woken_on_finish(void) {
+    struct waiter_woken future = {0};
+    run(4, &future, (tachy_poll_fn) &waiter_woken_poll, sizeof(future));
+}
+
+struct consume {
+    int done;
+    struct tachy_admit_handle admit;
+    struct tachy_join_handle joins[2];
+    tachy_state state;
+};
+
+enum tachy_poll consume_poll(struct consume *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->admit = tachy_admit(struct sleeper, 0);
+    tachy_await(tachy_admit_poll(&self->admit, NULL));
+    assert(self->admit.state == TACHY_ADMIT_COMPLETED);
+
+    for (int i = 0; i < 2; i++) {
+        struct sleeper child = sleeper(10, &self->done);
+        self->joins[i] = tachy_spawn(&child, (tachy_poll_fn) &sleeper_poll, 0);
+    }
+    assert(self->joins[0].state == TACHY_FUTURE_CREATED);
+    assert(self->joins[1].state == TACHY_ADMISSION_ERROR);
+
+    tachy_await(tachy_join_poll(&self->joins[0], NULL));
+    assert(self->done == 1);
+    tachy_return();
+    tachy_end;
+}
+
+void test_consume_reservation(void) {
+    struct consume future = {0};
+    run(2, &future, (tachy_poll_fn) &consume_poll, sizeof(future));
+}
+
+struct cancel_completed {
+    uint64_t admitted_at;
+    struct tachy_admit_handle admit;
+    struct tachy_join_handle join;
+    struct tachy_sleep_handle sleep;
+    tachy_state state;
+};
+
+enum tachy_poll cancel_completed_poll(struct cancel_completed *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    struct admitter waiter = {.count = 1, .admitted_at = &self->admitted_at};
+    self->join = tachy_spawn(&waiter, (tachy_poll_fn) &admitter_poll, 0);
+    self->admit = tachy_admit(struct sleeper, 0);
+    tachy_await(tachy_admit_poll(&self->admit, NULL));
+    assert(self->admit.state == TACHY_ADMIT_COMPLETED);
+
+    self->sleep = tachy_sleep((struct tachy_duration) {.msecs = 10});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    assert(self->admitted_at == 0);
+
+    tachy_admit_cancel(&self->admit);
+    tachy_await(tachy_join_poll(&self->join, NULL));
+    assert(self->admitted_at == 10);
+    tachy_return();
+    tachy_end;
+}
+
+void test_cancel_completed_admit(void) {
+    struct cancel_completed future = {0};
+    run(3, &future, (tachy_poll_fn) &cancel_completed_poll, sizeof(future));
+}
+
+struct oom_restore {
+    int done;
+    int helper_error;
+    struct tachy_join_handle helper;
+    struct tachy_admit_handle admit;
+    struct tachy_join_handle join;
+    tachy_state state;
+};
+
+enum tachy_poll oom_restore_poll(struct oom_restore *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    struct spawner helper = {.done = &self->done, .error = &self->helper_error};
+    self->helper = tachy_spawn(&helper, (tachy_poll_fn) &spawner_poll, 0);
+    self->admit = tachy__admit(1, HUGE_FUTURE_BYTES, 0);
+    tachy_await(tachy_admit_poll(&self->admit, NULL));
+
+    struct sleeper child = sleeper(10, &self->done);
+    self->join = tachy__spawn(&child, (tachy_poll_fn) &sleeper_poll, HUGE_FUTURE_BYTES, 0);
+    assert(self->join.state == TACHY_OUT_OF_MEMORY_ERROR);
+
+    tachy_await(tachy_join_poll(&self->helper, NULL));
+    assert(self->helper_error == TACHY_ADMISSION_ERROR);
+
+    child = sleeper(10, &self->done);
+    self->join = tachy_spawn(&child, (tachy_poll_fn) &sleeper_poll, 0);
+    assert(self->join.state == TACHY_FUTURE_CREATED);
+    tachy_await(tachy_join_poll(&self->join, NULL));
+    assert(self->done == 1);
+    tachy_return();
+    tachy_end;
+}
+
+void test_oom_restores_reservation(void) {
+    struct oom_restore future = {0};
+    run(3, &future, (tachy_poll_fn) &oom_restore_poll, sizeof(future));
+}
+
+int main(void) {
+    test_limit_rejects();
+    printf("✅ test_limit_rejects()\n");
+    test_waiter_woken_on_finish();
+    printf("✅ test_waiter_woken_on_finish()\n");
+    test_consume_reservation();
+    printf("✅ test_consume_reservation()\n");
+    test_cancel_completed_admit();
+    printf("✅ test_cancel_completed_admit()\n");
+    test_oom_restores_reservation();
+    printf("✅ test_oom_restores_reservation()\n");
+    return 0;
+}
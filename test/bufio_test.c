@@ -0,0 +1,179 @@
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../include/bufio.h"
+#include "../include/runtime.h"
+#include "../include/tachy.h"
+
+struct writer_task {
+    struct tachy_io *io;
+    bool linger;
+    char **leaked;
+    struct tachy_bufwriter writer;
+    int64_t n;
+    struct tachy_bufwrite_handle write;
+    struct tachy_sleep_handle sleep;
+    tachy_state state;
+};
+
+enum tachy_poll writer_task_poll(struct writer_task *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    bool initialised = tachy_bufwriter_init(&self->writer, self->io, 64);
+    assert(initialised);
+    *self->leaked = self->writer.buf;
+
+    self->write = tachy_bufwriter_write(&self->writer, "buffered", 8);
+    tachy_await(tachy_bufwriter_write_poll(&self->write, &self->n));
+    assert(self->n == 8);
+    assert(self->writer.scheduled);
+
+    if (self->linger) {
+        self->sleep = tachy_sleep((struct tachy_duration) {.secs = 60});
+        tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    }
+    tachy_return();
+    tachy_end;
+}
+
+struct pipe_full {
+    int fds[2];
+    struct tachy_io *io;
+    char *leaked;
+    struct tachy_scope scope;
+    struct tachy_join_handle join;
+    struct tachy_sleep_handle sleep;
+    tachy_state state;
+};
+
+static void fill(int fd) {
+    char chunk[4096] = {0};
+    while (write(fd, chunk, sizeof(chunk)) > 0) {}
+}
+
+static void open_full_pipe(struct pipe_full *self) {
+    int err = pipe2(self->fds, O_NONBLOCK | O_CLOEXEC);
+    assert(err == 0);
+    fill(self->fds[1]);
+    self->io = tachy_io_register(self->fds[1]);
+    assert(self->io != NULL);
+}
+
+static void close_pipe(struct pipe_full *self) {
+    tachy_io_deregister(self->io);
+    close(self->fds[0]);
+    close(self->fds[1]);
+    free(self->leaked);
+}
+
+enum tachy_poll dropped_poll(struct pipe_full *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    open_full_pipe(self);
+    tachy_scope_init(&self->scope);
+    struct writer_task child = {.io = self->io, .linger = true, .leaked = &self->leaked};
+    tachy_scope_spawn(&self->scope, &child, (tachy_poll_fn) &writer_task_poll);
+
+    self->sleep = tachy_sleep((struct tachy_duration) {.msecs = 10});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    assert(rt_bufwriter_queue()->head != NULL);
+    tachy_scope_cancel(&self->scope);
+
+    self->sleep = tachy_sleep((struct tachy_duration) {.msecs = 10});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    assert(rt_bufwriter_queue()->head == NULL);
+    close_pipe(self);
+    tachy_return();
+    tachy_end;
+}
+
+enum tachy_poll finished_poll(struct pipe_full *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    open_full_pipe(self);
+    struct writer_task child = {.io = self->io, .linger = false, .leaked = &self->leaked};
+    self->join = tachy_spawn(&child, (tachy_poll_fn) &writer_task_poll, 0);
+    tachy_await(tachy_join_poll(&self->join, NULL));
+    assert(rt_bufwriter_queue()->head == NULL);
+
+    self->sleep = tachy_sleep((struct tachy_duration) {.msecs = 10});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    close_pipe(self);
+    tachy_return();
+    tachy_end;
+}
+
+static void run(tachy_poll_fn poll_fn) {
+    struct tachy_config config = {.clock_mode = TACHY_CLOCK_VIRTUAL};
+    bool initialised = tachy_init_with_config(&config);
+    assert(initialised);
+    struct pipe_full future = {0};
+    tachy__block_on(&future, poll_fn, sizeof(future), NULL);
+    tachy_shutdown();
+}
+
+void test_dropped_task_unschedules_writer(void) {
+    run((tachy_poll_fn) &dropped_poll);
+}
+
+void test_finished_task_unschedules_writer(void) {
+    run((tachy_poll_fn) &finished_poll);
+}
+
+struct destroy {
+    int fds[2];
+    struct tachy_io *io;
+    struct tachy_bufwriter writer;
+    int64_t n;
+    struct tachy_bufwrite_handle write;
+    tachy_state state;
+};
+
+enum tachy_poll destroy_poll(struct destroy *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    int err = pipe2(self->fds, O_NONBLOCK | O_CLOEXEC);
+    assert(err == 0);
+    fill(self->fds[1]);
+    self->io = tachy_io_register(self->fds[1]);
+    bool initialised = tachy_bufwriter_init(&self->writer, self->io, 64);
+    assert(initialised);
+
+    self->write = tachy_bufwriter_write(&self->writer, "pending", 7);
+    tachy_await(tachy_bufwriter_write_poll(&self->write, &self->n));
+    bool destroyed = tachy_bufwriter_destroy(&self->writer);
+    assert(!destroyed);
+    assert(self->writer.end - self->writer.start == 7);
+
+    char drain[4096];
+    while (read(self->fds[0], drain, sizeof(drain)) > 0) {}
+    self->write = tachy_bufwriter_flush(&self->writer);
+    tachy_await(tachy_bufwriter_write_poll(&self->write, &self->n));
+    destroyed = tachy_bufwriter_destroy(&self->writer);
+    assert(destroyed);
+
+    tachy_io_deregister(self->io);
+    close(self->fds[0]);
+    close(self->fds[1]);
+    tachy_return();
+    tachy_end;
+}
+
+void test_destroy_keeps_unflushed_data(void) {
+    bool initialised = tachy_init();
+    assert(initialised);
+    struct destroy future = {0};
+    tachy_block_on(&future, (tachy_poll_fn) &destroy_poll, NULL);
+    tachy_shutdown();
+}
+
+int main(void) {
+    test_dropped_task_unschedules_writer();
+    printf("✅ test_dropped_task_unschedules_writer()\n");
+    test_finished_task_unschedules_writer();
+    printf("✅ test_finished_task_unschedules_writer()\n");
+    test_destroy_keeps_unflushed_data();
+    printf("✅ test_destroy_keeps_unflushed_data()\n");
+    return 0;
+}
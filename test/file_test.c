@@ -0,0 +1,154 @@
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/tachy.h"
+
+#define FILE_BYTES ((3 * 1024 * 1024) + 123)
+
+struct file_io {
+    const char *path;
+    char *data;
+    char *back;
+    int fd;
+    int64_t result;
+    struct tachy_file_handle file;
+    tachy_state state;
+};
+
+static void run(struct file_io *future, tachy_poll_fn poll_fn) {
+    bool initialised = tachy_init();
+    assert(initialised);
+    tachy_block_on(future, poll_fn, NULL);
+    tachy_shutdown();
+}
+
+static char *pattern(size_t len, unsigned int seed) {
+    char *buf = malloc(len);
+    assert(buf != NULL);
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (char) ((i * 31) + seed);
+    }
+    return buf;
+}
+
+enum tachy_poll round_trip_poll(struct file_io *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->file = tachy_file_open(self->path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    tachy_await(tachy_file_poll(&self->file, &self->result));
+    assert(self->result >= 0);
+    self->fd = (int) self->result;
+
+    self->file = tachy_file_write(self->fd, self->data, FILE_BYTES, 0);
+    tachy_await(tachy_file_poll(&self->file, &self->result));
+    assert(self->result == FILE_BYTES);
+
+    self->file = tachy_file_read(self->fd, self->back, FILE_BYTES, 0);
+    tachy_await(tachy_file_poll(&self->file, &self->result));
+    assert(self->result == FILE_BYTES);
+    assert(memcmp(self->data, self->back, FILE_BYTES) == 0);
+
+    memset(self->back, 0, FILE_BYTES);
+    self->file = tachy_file_read(self->fd, self->back, FILE_BYTES, FILE_BYTES - 100);
+    tachy_await(tachy_file_poll(&self->file, &self->result));
+    assert(self->result == 100);
+    assert(memcmp(self->data + FILE_BYTES - 100, self->back, 100) == 0);
+
+    self->file = tachy_file_read(self->fd, self->back, 10, FILE_BYTES);
+    tachy_await(tachy_file_poll(&self->file, &self->result));
+    assert(self->result == 0);
+
+    close(self->fd);
+    tachy_return();
+    tachy_end;
+}
+
+void test_round_trip(void) {
+    char path[] = "/tmp/tachy_file_test_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd != -1);
+    close(fd);
+
+    struct file_io future = {.path = path, .data = pattern(FILE_BYTES, 7), .back = malloc(FILE_BYTES)};
+    assert(future.back != NULL);
+    run(&future, (tachy_poll_fn) &round_trip_poll);
+    unlink(path);
+    free(future.data);
+    free(future.back);
+}
+
+enum tachy_poll append_poll(struct file_io *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->file = tachy_file_write(self->fd, self->data, FILE_BYTES, 0);
+    tachy_await(tachy_file_poll(&self->file, &self->result));
+    assert(self->result == FILE_BYTES);
+    tachy_return();
+    tachy_end;
+}
+
+void test_append_is_sequential(void) {
+    char path[] = "/tmp/tachy_file_test_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd != -1);
+    ssize_t n = write(fd, "head", 4);
+    assert(n == 4);
+    close(fd);
+
+    fd = open(path, O_WRONLY | O_APPEND);
+    assert(fd != -1);
+    struct file_io future = {.fd = fd, .data = pattern(FILE_BYTES, 3)};
+    run(&future, (tachy_poll_fn) &append_poll);
+    close(fd);
+
+    char *back = malloc(FILE_BYTES + 4);
+    assert(back != NULL);
+    fd = open(path, O_RDONLY);
+    assert(fd != -1);
+    n = pread(fd, back, FILE_BYTES + 4, 0);
+    assert(n == FILE_BYTES + 4);
+    assert(memcmp(back, "head", 4) == 0);
+    assert(memcmp(back + 4, future.data, FILE_BYTES) == 0);
+    close(fd);
+    unlink(path);
+    free(back);
+    free(future.data);
+}
+
+enum tachy_poll pipe_poll(struct file_io *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->file = tachy_file_read(self->fd, self->back, 64, 4096);
+    tachy_await(tachy_file_poll(&self->file, &self->result));
+    assert(self->result == 5);
+    assert(memcmp(self->back, "piped", 5) == 0);
+    tachy_return();
+    tachy_end;
+}
+
+void test_pipe_is_sequential(void) {
+    int fds[2];
+    int err = pipe(fds);
+    assert(err == 0);
+    ssize_t n = write(fds[1], "piped", 5);
+    assert(n == 5);
+    close(fds[1]);
+
+    char back[64];
+    struct file_io future = {.fd = fds[0], .back = back};
+    run(&future, (tachy_poll_fn) &pipe_poll);
+    close(fds[0]);
+}
+
+int main(void) {
+    test_round_trip();
+    printf("✅ test_round_trip()\n");
+    test_append_is_sequential();
+    printf("✅ test_append_is_sequential()\n");
+    test_pipe_is_sequential();
+    printf("✅ test_pipe_is_sequential()\n");
+    return 0;
+}
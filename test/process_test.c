@@ -0,0 +1,136 @@
+#include <assert.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#include "../include/tachy.h"
+
+static void run(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes) {
+    bool initialised = tachy_init();
+    assert(initialised);
+    tachy__block_on(future, poll_fn, future_size_bytes, NULL);
+    assert(tachy_task_usage().live_tasks == 0);
+    tachy_shutdown();
+}
+
+static struct tachy_process *spawn_sh(const char *script, enum tachy_stdio stdio_mode) {
+    char *argv[] = {"sh", "-c", (char *) script, NULL};
+    struct tachy_process_config config = {
+        .path = "/bin/sh",
+        .argv = argv,
+        .stdin_mode = stdio_mode,
+        .stdout_mode = stdio_mode,
+        .stderr_mode = TACHY_STDIO_INHERIT,
+    };
+    struct tachy_process *process = tachy_process_spawn(&config);
+    assert(process != NULL);
+    return process;
+}
+
+struct echo {
+    struct tachy_process *process;
+    char buf[32];
+    size_t len;
+    int64_t n;
+    int64_t status;
+    struct tachy_io_rw_handle io;
+    struct tachy_process_wait_handle wait;
+    tachy_state state;
+};
+
+enum tachy_poll echo_poll(struct echo *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->process = spawn_sh("read line; echo \"got:$line\"; exit 3", TACHY_STDIO_PIPE);
+    assert(tachy_process_pid(self->process) > 0);
+
+    self->io = tachy_write(tachy_process_stdin(self->process), "hi\n", 3);
+    tachy_await(tachy_write_poll(&self->io, &self->n));
+    assert(self->n == 3);
+    tachy_process_close_stdin(self->process);
+
+    do {
+        self->io = tachy_read(tachy_process_stdout(self->process), self->buf + self->len,
+                              sizeof(self->buf) - 1 - self->len);
+        tachy_await(tachy_read_poll(&self->io, &self->n));
+        assert(self->n >= 0);
+        self->len += (size_t) self->n;
+    } while (self->n > 0);
+    assert(strcmp(self->buf, "got:hi\n") == 0);
+
+    self->wait = tachy_process_wait(self->process);
+    tachy_await(tachy_process_wait_poll(&self->wait, &self->status));
+    assert(WIFEXITED(self->status) && WEXITSTATUS(self->status) == 3);
+    tachy_process_free(self->process);
+    tachy_return();
+    tachy_end;
+}
+
+void test_spawn_pipes_and_wait(void) {
+    struct echo future = {0};
+    run(&future, (tachy_poll_fn) &echo_poll, sizeof(future));
+}
+
+struct killed {
+    struct tachy_process *process;
+    int64_t status;
+    struct tachy_process_wait_handle wait;
+    tachy_state state;
+};
+
+enum tachy_poll killed_poll(struct killed *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->process = spawn_sh("sleep 10", TACHY_STDIO_NULL);
+    bool sent = tachy_process_kill(self->process, SIGTERM);
+    assert(sent);
+
+    self->wait = tachy_process_wait(self->process);
+    tachy_await(tachy_process_wait_poll(&self->wait, &self->status));
+    assert(WIFSIGNALED(self->status) && WTERMSIG(self->status) == SIGTERM);
+    assert(!tachy_process_kill(self->process, SIGTERM) && errno == ESRCH);
+    tachy_process_free(self->process);
+    tachy_return();
+    tachy_end;
+}
+
+void test_kill_and_wait(void) {
+    struct killed future = {0};
+    run(&future, (tachy_poll_fn) &killed_poll, sizeof(future));
+}
+
+struct orphan {
+    pid_t pid;
+    struct tachy_sleep_handle sleep;
+    tachy_state state;
+};
+
+enum tachy_poll orphan_poll(struct orphan *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    struct tachy_process *process = spawn_sh("sleep 0.05", TACHY_STDIO_PIPE);
+    self->pid = tachy_process_pid(process);
+    tachy_process_free(process);
+    assert(tachy_task_usage().live_tasks == 2);
+
+    self->sleep = tachy_sleep((struct tachy_duration) {.msecs = 500});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    assert(tachy_task_usage().live_tasks == 1);
+    assert(waitpid(self->pid, NULL, WNOHANG) == -1 && errno == ECHILD);
+    tachy_return();
+    tachy_end;
+}
+
+void test_free_reaps_running_child(void) {
+    struct orphan future = {0};
+    run(&future, (tachy_poll_fn) &orphan_poll, sizeof(future));
+}
+
+int main(void) {
+    test_spawn_pipes_and_wait();
+    printf("✅ test_spawn_pipes_and_wait()\n");
+    test_kill_and_wait();
+    printf("✅ test_kill_and_wait()\n");
+    test_free_reaps_running_child();
+    printf("✅ test_free_reaps_running_child()\n");
+    return 0;
+}
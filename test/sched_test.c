@@ -0,0 +1,219 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../include/tachy.h"
+#include "../include/task.h"
+
+#define FAN_OUT 256
+
+static void run(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes) {
+    bool initialised = tachy_init();
+    assert(initialised);
+    tachy__block_on(future, poll_fn, future_size_bytes, NULL);
+    assert(tachy_task_usage().live_tasks == 0);
+    tachy_shutdown();
+}
+
+struct square {
+    int in;
+    tachy_state state;
+};
+
+enum tachy_poll square_poll(struct square *self, int *output) {
+    tachy_begin(&self->state);
+    tachy_return(self->in * self->in);
+    tachy_end;
+}
+
+struct fan_out {
+    struct square squares[FAN_OUT];
+    int outputs[FAN_OUT];
+    struct tachy_task_usage before;
+    struct tachy_join_set_handle joins;
+    tachy_state state;
+};
+
+enum tachy_poll fan_out_poll(struct fan_out *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    for (int i = 0; i < FAN_OUT; i++) {
+        self->squares[i] = (struct square) {.in = i};
+    }
+
+    self->before = tachy_task_usage();
+    self->joins = tachy_spawn_n(self->squares, FAN_OUT, (tachy_poll_fn) &square_poll, sizeof(int));
+    assert(self->joins.state == TACHY_FUTURE_CREATED);
+
+    struct tachy_task_usage usage = tachy_task_usage();
+    assert(usage.live_tasks == self->before.live_tasks + FAN_OUT);
+    assert(usage.task_bytes - self->before.task_bytes ==
+           task_block_alloc_size(FAN_OUT, sizeof(struct square), sizeof(int)));
+    assert(tachy_queue_depth(TACHY_PRIORITY_NORMAL) == FAN_OUT);
+
+    tachy_await(tachy_join_set_poll(&self->joins, self->outputs));
+    for (int i = 0; i < FAN_OUT; i++) {
+        assert(self->outputs[i] == i * i);
+    }
+    tachy_return();
+    tachy_end;
+}
+
+void test_spawn_n_one_block(void) {
+    struct fan_out future = {0};
+    run(&future, (tachy_poll_fn) &fan_out_poll, sizeof(future));
+}
+
+struct tagged {
+    char tag;
+    char **log;
+    tachy_state state;
+};
+
+enum tachy_poll tagged_poll(struct tagged *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    *(*self->log)++ = self->tag;
+    tachy_return();
+    tachy_end;
+}
+
+static void spawn_tagged(char tag, char **log, enum tachy_priority priority, int count) {
+    for (int i = 0; i < count; i++) {
+        struct tagged future = {.tag = tag, .log = log};
+        struct tachy_join_handle join = tachy_spawn_with_priority(&future, (tachy_poll_fn) &tagged_poll, 0, priority);
+        assert(join.state == TACHY_FUTURE_CREATED);
+        tachy_join_detach(&join);
+    }
+}
+
+void test_weighted_priorities(void) {
+    bool initialised = tachy_init();
+    assert(initialised);
+
+    char order[64] = {0};
+    char *log = order;
+    spawn_tagged('b', &log, TACHY_PRIORITY_BACKGROUND, 20);
+    spawn_tagged('n', &log, TACHY_PRIORITY_NORMAL, 20);
+    spawn_tagged('h', &log, TACHY_PRIORITY_HIGH, 20);
+    assert(tachy_queue_depth(TACHY_PRIORITY_HIGH) == 20);
+    assert(tachy_queue_depth(TACHY_PRIORITY_NORMAL) == 20);
+    assert(tachy_queue_depth(TACHY_PRIORITY_BACKGROUND) == 20);
+
+    // Weights 16/4/1: high goes first, but every round still serves the lower classes.
+    assert(tachy_run_once(64) == 60);
+    assert(strcmp(order, "hhhhhhhhhhhhhhhh" "nnnnb" "hhhh" "nnnnb" "nnnnb" "nnnnb" "nnnnb" "bbbbbbbbbbbbbbb") == 0);
+    for (int p = 0; p < TACHY_PRIORITY_COUNT; p++) {
+        assert(tachy_queue_depth(p) == 0);
+    }
+    assert(tachy_task_usage().live_tasks == 0);
+    tachy_shutdown();
+}
+
+struct counter {
+    int next;
+    tachy_state state;
+};
+
+enum tachy_poll counter_poll(struct counter *self, int *output) {
+    tachy_begin(&self->state);
+    while (true) {
+        tachy_yield_value(self->next++);
+    }
+    tachy_end;
+}
+
+struct observer {
+    int *watched;
+    int *seen;
+    tachy_state state;
+};
+
+enum tachy_poll observer_poll(struct observer *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    *self->seen = *self->watched;
+    tachy_return();
+    tachy_end;
+}
+
+struct greedy {
+    int consumed;
+    int seen;
+    int item;
+    size_t count;
+    struct counter counter;
+    struct tachy_stream_next_handle next;
+    struct tachy_join_handle join;
+    tachy_state state;
+};
+
+enum tachy_poll greedy_poll(struct greedy *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->seen = -1;
+    struct observer observer = {.watched = &self->consumed, .seen = &self->seen};
+    self->join = tachy_spawn(&observer, (tachy_poll_fn) &observer_poll, 0);
+
+    // The stream is always ready, so only the budget lets the observer in.
+    while (self->consumed < 4 * TASK_POLL_BUDGET) {
+        self->next = tachy_stream_next(&self->counter, &counter_poll, &self->item);
+        tachy_await(tachy_stream_next_poll(&self->next, &self->count));
+        assert(self->count == 1 && self->item == self->consumed);
+        self->consumed++;
+    }
+    assert(self->seen == TASK_POLL_BUDGET);
+
+    tachy_await(tachy_join_poll(&self->join, NULL));
+    tachy_return();
+    tachy_end;
+}
+
+void test_budget_defers_greedy_task(void) {
+    struct greedy future = {0};
+    run(&future, (tachy_poll_fn) &greedy_poll, sizeof(future));
+}
+
+struct chain {
+    int depth;
+    char **log;
+    struct tachy_join_handle join;
+    tachy_state state;
+};
+
+enum tachy_poll chain_poll(struct chain *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    if (self->depth == 1) {
+        struct tagged bystander = {.tag = 'b', .log = self->log};
+        int error = tachy_spawn_no_join(&bystander, (tachy_poll_fn) &tagged_poll, 0);
+        assert(error == TACHY_FUTURE_CREATED);
+    }
+
+    if (self->depth > 0) {
+        struct chain child = {.depth = self->depth - 1, .log = self->log};
+        self->join = tachy_spawn(&child, (tachy_poll_fn) &chain_poll, 0);
+        tachy_await(tachy_join_poll(&self->join, NULL));
+    }
+    *(*self->log)++ = (char) ('0' + self->depth);
+    tachy_return();
+    tachy_end;
+}
+
+void test_next_task_streak_cap(void) {
+    char order[16] = {0};
+    char *log = order;
+    struct chain future = {.depth = 5, .log = &log};
+    run(&future, (tachy_poll_fn) &chain_poll, sizeof(future));
+
+    // Each finished child hands its joiner the next-task slot; after three handoffs in a row the
+    // queued bystander runs first.
+    assert(strcmp(order, "0123b45") == 0);
+}
+
+int main(void) {
+    test_spawn_n_one_block();
+    printf("✅ test_spawn_n_one_block()\n");
+    test_weighted_priorities();
+    printf("✅ test_weighted_priorities()\n");
+    test_budget_defers_greedy_task();
+    printf("✅ test_budget_defers_greedy_task()\n");
+    test_next_task_streak_cap();
+    printf("✅ test_next_task_streak_cap()\n");
+    return 0;
+}
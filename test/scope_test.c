@@ -0,0 +1,291 @@
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "../include/tachy.h"
+#include "../include/task.h"
+
+struct sleeper {
+    uint64_t msecs;
+    int *done;
+    struct tachy_sleep_handle sleep;
+    tachy_state state;
+};
+
+tachy_frame_budget(sleeper, struct sleeper, 48);
+
+static struct sleeper sleeper(uint64_t msecs, int *done) {
+    return (struct sleeper) {.msecs = msecs, .done = done};
+}
+
+enum tachy_poll sleeper_poll(struct sleeper *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->sleep = tachy_sleep((struct tachy_duration) {.msecs = self->msecs});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    (*self->done)++;
+    tachy_return();
+    tachy_end;
+}
+
+struct reader {
+    struct tachy_io *io;
+    int *done;
+    char buf[8];
+    int64_t n;
+    struct tachy_io_rw_handle read;
+    tachy_state state;
+};
+
+enum tachy_poll reader_poll(struct reader *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->read = tachy_read(self->io, self->buf, sizeof(self->buf));
+    tachy_await(tachy_read_poll(&self->read, &self->n));
+    (*self->done)++;
+    tachy_return();
+    tachy_end;
+}
+
+struct joiner {
+    struct tachy_join_handle join;
+    int *done;
+    tachy_state state;
+};
+
+enum tachy_poll joiner_poll(struct joiner *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    tachy_await(tachy_join_poll(&self->join, NULL));
+    (*self->done)++;
+    tachy_return();
+    tachy_end;
+}
+
+struct owner {
+    struct tachy_scope scope;
+    int *done;
+    struct tachy_scope_join_handle join;
+    tachy_state state;
+};
+
+enum tachy_poll early_owner_poll(struct owner *self, long *output) {
+    tachy_begin(&self->state);
+    tachy_scope_init(&self->scope);
+    struct sleeper child = sleeper(60000, self->done);
+    tachy_scope_spawn(&self->scope, &child, (tachy_poll_fn) &sleeper_poll);
+    tachy_return(0x4141414141414141L);
+    tachy_end;
+}
+
+enum tachy_poll nested_owner_poll(struct owner *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    tachy_scope_init(&self->scope);
+    for (int i = 0; i < 3; i++) {
+        struct sleeper child = sleeper(60000, self->done);
+        tachy_scope_spawn(&self->scope, &child, (tachy_poll_fn) &sleeper_poll);
+    }
+    self->join = tachy_scope_join(&self->scope);
+    tachy_await(tachy_scope_join_poll(&self->join, NULL));
+    (*self->done) += 100;
+    tachy_return();
+    tachy_end;
+}
+
+static void run(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes) {
+    struct tachy_config config = {.clock_mode = TACHY_CLOCK_VIRTUAL};
+    bool initialised = tachy_init_with_config(&config);
+    assert(initialised);
+    tachy__block_on(future, poll_fn, future_size_bytes, NULL);
+    assert(tachy_task_usage().live_tasks == 0);
+    tachy_shutdown();
+}
+
+struct join_all {
+    int done;
+    struct tachy_scope scope;
+    struct tachy_scope_join_handle join;
+    tachy_state state;
+};
+
+enum tachy_poll join_all_poll(struct join_all *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    tachy_scope_init(&self->scope);
+    struct sleeper children[4];
+    for (int i = 0; i < 4; i++) {
+        children[i] = sleeper(10 * (i + 1), &self->done);
+    }
+    int err = tachy_scope_spawn_n(&self->scope, children, 4, (tachy_poll_fn) &sleeper_poll);
+    assert(err == TACHY_FUTURE_CREATED);
+    err = tachy_scope_spawn(&self->scope, &children[0], (tachy_poll_fn) &sleeper_poll);
+    assert(err == TACHY_FUTURE_CREATED);
+    assert(tachy_scope_live(&self->scope) == 5);
+
+    self->join = tachy_scope_join(&self->scope);
+    tachy_await(tachy_scope_join_poll(&self->join, NULL));
+    assert(self->done == 5);
+    assert(tachy_scope_live(&self->scope) == 0);
+    tachy_return();
+    tachy_end;
+}
+
+void test_join_all(void) {
+    struct join_all future = {0};
+    run(&future, (tachy_poll_fn) &join_all_poll, sizeof(future));
+}
+
+struct early_return {
+    int done;
+    long out;
+    struct owner owner;
+    struct tachy_join_handle join;
+    struct tachy_sleep_handle sleep;
+    tachy_state state;
+};
+
+enum tachy_poll early_return_poll(struct early_return *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->owner = (struct owner) {.done = &self->done};
+    self->join = tachy_spawn(&self->owner, (tachy_poll_fn) &early_owner_poll, sizeof(long));
+    tachy_await(tachy_join_poll(&self->join, &self->out));
+    assert(self->join.state == TACHY_JOIN_COMPLETED);
+    assert(self->out == 0x4141414141414141L);
+
+    self->sleep = tachy_sleep((struct tachy_duration) {.secs = 120});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    assert(self->done == 0);
+    tachy_return();
+    tachy_end;
+}
+
+void test_owner_early_return(void) {
+    struct early_return future = {0};
+    run(&future, (tachy_poll_fn) &early_return_poll, sizeof(future));
+}
+
+struct cancel_blocked {
+    int done;
+    int fds[2];
+    struct tachy_io *io;
+    struct tachy_scope scope;
+    struct tachy_join_handle target;
+    struct tachy_sleep_handle sleep;
+    tachy_state state;
+};
+
+enum tachy_poll cancel_blocked_poll(struct cancel_blocked *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    int err = pipe2(self->fds, O_NONBLOCK | O_CLOEXEC);
+    assert(err == 0);
+    self->io = tachy_io_register(self->fds[0]);
+    assert(self->io != NULL);
+
+    struct sleeper target = sleeper(1000, &self->done);
+    self->target = tachy_spawn(&target, (tachy_poll_fn) &sleeper_poll, 0);
+
+    tachy_scope_init(&self->scope);
+    struct sleeper sleeping = sleeper(60000, &self->done);
+    struct reader reading = {.io = self->io, .done = &self->done};
+    struct joiner joining = {.join = tachy_spawn(&target, (tachy_poll_fn) &sleeper_poll, 0), .done = &self->done};
+    tachy_scope_spawn(&self->scope, &sleeping, (tachy_poll_fn) &sleeper_poll);
+    tachy_scope_spawn(&self->scope, &reading, (tachy_poll_fn) &reader_poll);
+    tachy_scope_spawn(&self->scope, &joining, (tachy_poll_fn) &joiner_poll);
+
+    self->sleep = tachy_sleep((struct tachy_duration) {.msecs = 10});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    assert(tachy_scope_live(&self->scope) == 3);
+    tachy_scope_cancel(&self->scope);
+    assert(tachy_scope_live(&self->scope) == 0);
+
+    ssize_t n = write(self->fds[1], "x", 1);
+    assert(n == 1);
+    self->sleep = tachy_sleep((struct tachy_duration) {.secs = 120});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    assert(self->done == 2);
+
+    tachy_await(tachy_join_poll(&self->target, NULL));
+    assert(self->target.state == TACHY_JOIN_COMPLETED);
+
+    tachy_io_deregister(self->io);
+    close(self->fds[0]);
+    close(self->fds[1]);
+    tachy_return();
+    tachy_end;
+}
+
+void test_cancel_blocked_children(void) {
+    struct cancel_blocked future = {0};
+    run(&future, (tachy_poll_fn) &cancel_blocked_poll, sizeof(future));
+}
+
+struct nested {
+    int done;
+    struct tachy_scope scope;
+    struct tachy_sleep_handle sleep;
+    tachy_state state;
+};
+
+enum tachy_poll nested_poll(struct nested *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    tachy_scope_init(&self->scope);
+    for (int i = 0; i < 2; i++) {
+        struct owner owner = {.done = &self->done};
+        tachy_scope_spawn(&self->scope, &owner, (tachy_poll_fn) &nested_owner_poll);
+    }
+
+    self->sleep = tachy_sleep((struct tachy_duration) {.msecs = 10});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    assert(tachy_task_usage().live_tasks == 9);
+    tachy_scope_cancel(&self->scope);
+
+    self->sleep = tachy_sleep((struct tachy_duration) {.secs = 120});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    assert(self->done == 0);
+    tachy_return();
+    tachy_end;
+}
+
+void test_nested_scopes(void) {
+    struct nested future = {0};
+    run(&future, (tachy_poll_fn) &nested_poll, sizeof(future));
+}
+
+struct join_canceled {
+    int done;
+    struct tachy_join_handle join;
+    tachy_state state;
+};
+
+enum tachy_poll join_canceled_poll(struct join_canceled *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    struct sleeper target = sleeper(1000, &self->done);
+    self->join = tachy_spawn(&target, (tachy_poll_fn) &sleeper_poll, 0);
+    task_cancel(self->join.task);
+    tachy_await(tachy_join_poll(&self->join, NULL));
+    assert(self->join.state == TACHY_CANCELED_ERROR);
+    assert(self->done == 0);
+    tachy_join_detach(&self->join);
+    assert(self->join.state == TACHY_JOIN_DETACHED);
+    assert(self->join.task == NULL);
+    tachy_return();
+    tachy_end;
+}
+
+void test_join_canceled(void) {
+    struct join_canceled future = {0};
+    run(&future, (tachy_poll_fn) &join_canceled_poll, sizeof(future));
+}
+
+int main(void) {
+    test_join_all();
+    printf("✅ test_join_all()\n");
+    test_owner_early_return();
+    printf("✅ test_owner_early_return()\n");
+    test_cancel_blocked_children();
+    printf("✅ test_cancel_blocked_children()\n");
+    test_nested_scopes();
+    printf("✅ test_nested_scopes()\n");
+    test_join_canceled();
+    printf("✅ test_join_canceled()\n");
+    return 0;
+}
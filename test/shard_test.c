@@ -0,0 +1,141 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../include/tachy.h"
+
+#define MESSAGES 20000
+
+struct sender {
+    size_t to;
+    uintptr_t sent;
+    struct tachy_yield_handle yield;
+    tachy_state state;
+};
+
+enum tachy_poll sender_poll(struct sender *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    while (self->sent < MESSAGES) {
+        if (tachy_shard_send(self->to, (void *) (self->sent + 1))) {
+            self->sent++;
+            continue;
+        }
+
+        self->yield = tachy_yield();
+        tachy_await(tachy_yield_poll(&self->yield, NULL));
+    }
+    tachy_return();
+    tachy_end;
+}
+
+struct receiver {
+    uintptr_t received;
+    void *message;
+    struct tachy_shard_recv_handle recv;
+    tachy_state state;
+};
+
+enum tachy_poll receiver_poll(struct receiver *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    while (self->received < MESSAGES) {
+        self->recv = tachy_shard_recv();
+        tachy_await(tachy_shard_recv_poll(&self->recv, &self->message));
+        assert(self->recv.state == TACHY_SHARD_RECV_COMPLETED);
+        assert((uintptr_t) self->message == self->received + 1);
+        self->received++;
+    }
+    tachy_return();
+    tachy_end;
+}
+
+struct exchange {
+    struct tachy_join_handle send;
+    struct tachy_join_handle recv;
+    tachy_state state;
+};
+
+enum tachy_poll exchange_poll(struct exchange *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    struct receiver receiver = {0};
+    self->recv = tachy_spawn(&receiver, (tachy_poll_fn) &receiver_poll, 0);
+    struct sender sender = {.to = 1 - tachy_shard_id()};
+    self->send = tachy_spawn(&sender, (tachy_poll_fn) &sender_poll, 0);
+    tachy_await(tachy_join_poll(&self->send, NULL));
+    tachy_await(tachy_join_poll(&self->recv, NULL));
+    assert(self->recv.state == TACHY_JOIN_COMPLETED);
+    tachy_return();
+    tachy_end;
+}
+
+static void exchange_main(TACHY_UNUSED size_t shard_id, TACHY_UNUSED void *arg) {
+    struct exchange future = {0};
+    tachy_block_on(&future, (tachy_poll_fn) &exchange_poll, NULL);
+}
+
+void test_two_way_exchange(void) {
+    struct tachy_shard_config config = {.shard_count = 2, .ring_capacity = 64, .main = exchange_main};
+    bool ok = tachy_shards_run(&config);
+    assert(ok);
+}
+
+struct recv_one {
+    void *message;
+    struct tachy_shard_recv_handle recv;
+    tachy_state state;
+};
+
+enum tachy_poll recv_one_poll(struct recv_one *self, int *output) {
+    tachy_begin(&self->state);
+    self->recv = tachy_shard_recv();
+    tachy_await(tachy_shard_recv_poll(&self->recv, &self->message));
+    assert(self->recv.state != TACHY_SHARD_RECV_COMPLETED || self->message == (void *) 1);
+    tachy_return(self->recv.state);
+    tachy_end;
+}
+
+struct busy {
+    int first;
+    int second;
+    struct tachy_join_handle joins[2];
+    struct tachy_yield_handle yield;
+    tachy_state state;
+};
+
+enum tachy_poll busy_poll(struct busy *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    struct recv_one recv = {0};
+    self->joins[0] = tachy_spawn(&recv, (tachy_poll_fn) &recv_one_poll, sizeof(int));
+    self->yield = tachy_yield();
+    tachy_await(tachy_yield_poll(&self->yield, NULL));
+
+    recv = (struct recv_one) {0};
+    self->joins[1] = tachy_spawn(&recv, (tachy_poll_fn) &recv_one_poll, sizeof(int));
+    tachy_await(tachy_join_poll(&self->joins[1], &self->second));
+    assert(self->second == TACHY_SHARD_BUSY_ERROR);
+
+    bool sent = tachy_shard_send(tachy_shard_id(), (void *) 1);
+    assert(sent);
+    tachy_await(tachy_join_poll(&self->joins[0], &self->first));
+    assert(self->first == TACHY_SHARD_RECV_COMPLETED);
+    tachy_return();
+    tachy_end;
+}
+
+static void busy_main(TACHY_UNUSED size_t shard_id, TACHY_UNUSED void *arg) {
+    struct busy future = {0};
+    tachy_block_on(&future, (tachy_poll_fn) &busy_poll, NULL);
+}
+
+void test_second_receiver_busy(void) {
+    struct tachy_shard_config config = {.shard_count = 1, .main = busy_main};
+    bool ok = tachy_shards_run(&config);
+    assert(ok);
+}
+
+int main(void) {
+    test_two_way_exchange();
+    printf("✅ test_two_way_exchange()\n");
+    test_second_receiver_busy();
+    printf("✅ test_second_receiver_busy()\n");
+    return 0;
+}
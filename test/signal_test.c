@@ -0,0 +1,49 @@
+#include <assert.h>
+#include <signal.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "../include/tachy.h"
+
+struct pending {
+    struct tachy_signal_handle signal;
+    struct tachy_yield_handle yield;
+    tachy_state state;
+};
+
+enum tachy_poll pending_poll(struct pending *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->signal = tachy_signal(SIGUSR1);
+    assert(self->signal.state == TACHY_SIGNAL_REGISTERED);
+    tachy_signal_cancel(&self->signal);
+
+    kill(getpid(), SIGUSR1);
+    self->yield = tachy_yield();
+    tachy_await(tachy_yield_poll(&self->yield, NULL));
+
+    self->signal = tachy_signal(SIGUSR1);
+    assert(tachy_signal_poll(&self->signal, NULL) == TACHY_POLL_READY);
+    assert(self->signal.state == TACHY_SIGNAL_COMPLETED);
+
+    self->signal = tachy_signal(SIGUSR1);
+    assert(tachy_signal_poll(&self->signal, NULL) == TACHY_POLL_PENDING);
+    kill(getpid(), SIGUSR1);
+    tachy_await(tachy_signal_poll(&self->signal, NULL));
+    assert(self->signal.state == TACHY_SIGNAL_COMPLETED);
+    tachy_return();
+    tachy_end;
+}
+
+void test_signal_before_wait(void) {
+    bool initialised = tachy_init();
+    assert(initialised);
+    struct pending future = {0};
+    tachy_block_on(&future, (tachy_poll_fn) &pending_poll, NULL);
+    tachy_shutdown();
+}
+
+int main(void) {
+    test_signal_before_wait();
+    printf("✅ test_signal_before_wait()\n");
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/tachy.h"
+
+#define RANGE_END 10
+
+static void run(void *future, tachy_poll_fn poll_fn, size_t future_size_bytes) {
+    bool initialised = tachy_init();
+    assert(initialised);
+    tachy__block_on(future, poll_fn, future_size_bytes, NULL);
+    tachy_shutdown();
+}
+
+struct range {
+    int next;
+    tachy_state state;
+};
+
+enum tachy_poll range_poll(struct range *self, int *output) {
+    tachy_begin(&self->state);
+    while (self->next < RANGE_END) {
+        tachy_yield_value(self->next++);
+    }
+    tachy_return();
+    tachy_end;
+}
+
+struct single {
+    int expected;
+    int item;
+    size_t count;
+    struct range range;
+    struct tachy_stream_next_handle next;
+    tachy_state state;
+};
+
+enum tachy_poll single_poll(struct single *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    do {
+        self->next = tachy_stream_next(&self->range, &range_poll, &self->item);
+        tachy_await(tachy_stream_next_poll(&self->next, &self->count));
+        if (self->count == 1) {
+            assert(self->item == self->expected);
+            self->expected++;
+        }
+    } while (!self->next.ended);
+    assert(self->count == 0);
+    assert(self->expected == RANGE_END);
+    tachy_return();
+    tachy_end;
+}
+
+void test_next_single(void) {
+    struct single future = {0};
+    run(&future, (tachy_poll_fn) &single_poll, sizeof(future));
+}
+
+struct batch {
+    int items[4];
+    size_t counts[4];
+    int batches;
+    struct range range;
+    struct tachy_stream_next_handle next;
+    tachy_state state;
+};
+
+enum tachy_poll batch_poll(struct batch *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    do {
+        self->next = tachy_stream_next_batch(&self->range, &range_poll, self->items, 4);
+        tachy_await(tachy_stream_next_poll(&self->next, &self->counts[self->batches]));
+        for (size_t i = 0; i < self->counts[self->batches]; i++) {
+            assert(self->items[i] == (self->batches * 4) + (int) i);
+        }
+        self->batches++;
+    } while (!self->next.ended);
+
+    assert(self->batches == 3);
+    assert(self->counts[0] == 4 && self->counts[1] == 4 && self->counts[2] == 2);
+    tachy_return();
+    tachy_end;
+}
+
+void test_next_batch(void) {
+    struct batch future = {0};
+    run(&future, (tachy_poll_fn) &batch_poll, sizeof(future));
+}
+
+static void expect_abort(void (*fn)(void)) {
+    pid_t pid = fork();
+    assert(pid != -1);
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDERR_FILENO);
+        fn();
+        _exit(0);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT);
+}
+
+struct direct_await {
+    int item;
+    struct range range;
+    tachy_state state;
+};
+
+enum tachy_poll direct_await_poll(struct direct_await *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    tachy_await(range_poll(&self->range, &self->item));
+    tachy_return();
+    tachy_end;
+}
+
+static void await_stream(void) {
+    struct direct_await future = {0};
+    run(&future, (tachy_poll_fn) &direct_await_poll, sizeof(future));
+}
+
+struct spawned {
+    struct tachy_yield_handle yield;
+    tachy_state state;
+};
+
+enum tachy_poll spawned_poll(struct spawned *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    struct range range = {0};
+    int error = tachy_spawn_no_join(&range, (tachy_poll_fn) &range_poll, sizeof(int));
+    assert(error == TACHY_FUTURE_CREATED);
+    self->yield = tachy_yield();
+    tachy_await(tachy_yield_poll(&self->yield, NULL));
+    tachy_return();
+    tachy_end;
+}
+
+static void spawn_stream(void) {
+    struct spawned future = {0};
+    run(&future, (tachy_poll_fn) &spawned_poll, sizeof(future));
+}
+
+void test_item_outside_stream_next_asserts(void) {
+    expect_abort(await_stream);
+    expect_abort(spawn_stream);
+}
+
+int main(void) {
+    test_next_single();
+    printf("✅ test_next_single()\n");
+    test_next_batch();
+    printf("✅ test_next_batch()\n");
+    test_item_outside_stream_next_asserts();
+    printf("✅ test_item_outside_stream_next_asserts()\n");
+    return 0;
+}
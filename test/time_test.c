@@ -2,8 +2,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <time.h>
 
+#include "../include/tachy.h"
 #include "../include/task.h"
 #include "../include/time_driver.h"
 
@@ -176,6 +178,81 @@ void test_max_timeout_boundary(void) {
     free(entry);
 }
 
+struct backoff_future {
+    struct tachy_sleep_handle sleep;
+    uint64_t delay_ms;
+    int attempt;
+    tachy_state state;
+};
+
+enum tachy_poll backoff_poll(struct backoff_future *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    for (self->attempt = 0; self->attempt < 20; self->attempt++) {
+        self->delay_ms = (self->delay_ms == 0) ? 1000 : TACHY_MIN(self->delay_ms * 2, 3600 * 1000);
+        self->delay_ms += tachy_random() % 100;
+        self->sleep = tachy_sleep((struct tachy_duration) {.msecs = self->delay_ms});
+        tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    }
+    tachy_return();
+    tachy_end;
+}
+
+uint64_t run_virtual_backoff(uint64_t seed) {
+    struct tachy_config config = {.clock_mode = TACHY_CLOCK_VIRTUAL, .seed = seed};
+    bool initialised = tachy_init_with_config(&config);
+    assert(initialised);
+
+    struct backoff_future future = {0};
+    tachy_block_on(&future, (tachy_poll_fn) &backoff_poll, NULL);
+    uint64_t simulated = tachy_now_ms();
+    tachy_shutdown();
+    return simulated;
+}
+
+void test_virtual_clock(void) {
+    uint64_t simulated = run_virtual_backoff(42);
+    assert(simulated > 8 * 3600 * 1000);
+    assert(run_virtual_backoff(42) == simulated);
+}
+
+struct flag_sleep {
+    bool *done;
+    struct tachy_sleep_handle sleep;
+    tachy_state state;
+};
+
+enum tachy_poll flag_sleep_poll(struct flag_sleep *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    self->sleep = tachy_sleep((struct tachy_duration) {.msecs = 5000});
+    tachy_await(tachy_sleep_poll(&self->sleep, NULL));
+    *self->done = true;
+    tachy_return();
+    tachy_end;
+}
+
+void test_virtual_run_once(void) {
+    struct tachy_config config = {.clock_mode = TACHY_CLOCK_VIRTUAL};
+    bool initialised = tachy_init_with_config(&config);
+    assert(initialised);
+
+    bool done = false;
+    struct flag_sleep future = {.done = &done};
+    int error = tachy_spawn_no_join(&future, (tachy_poll_fn) &flag_sleep_poll, 0);
+    assert(error == TACHY_FUTURE_CREATED);
+    assert(tachy_run_once(16) == 1);
+
+    struct epoll_event event;
+    assert(epoll_wait(tachy_get_fd(), &event, 1, 0) == 0);
+    assert(tachy_now_ms() == 0);
+
+    for (int i = 0; i < 8 && !done; i++) {
+        tachy_run_once(16);
+    }
+    assert(done);
+    assert(tachy_now_ms() == 5000);
+    tachy_shutdown();
+}
+
 int test_huge_number_of_timers(void) {
     time_t seed = time(NULL);
     printf("test_huge_number_of_timers(): Using seed %ld\n", seed);
@@ -240,6 +317,10 @@ int test_huge_number_of_timers(void) {
 }
 
 int main(void) {
+    test_virtual_clock();
+    printf("✅ test_virtual_clock()\n");
+    test_virtual_run_once();
+    printf("✅ test_virtual_run_once()\n");
     test_insert_timeout_and_expiration();
     printf("✅ test_insert_timeout_and_expiration()\n");
     test_insert_expired();
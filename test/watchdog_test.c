@@ -0,0 +1,83 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "../include/tachy.h"
+
+static atomic_int reports;
+static _Atomic(tachy_poll_fn) reported_fn;
+static _Atomic uint64_t reported_ns;
+
+static void on_long_poll(const struct tachy_long_poll *poll, TACHY_UNUSED void *arg) {
+    atomic_fetch_add(&reports, 1);
+    atomic_store(&reported_fn, poll->poll_fn);
+    atomic_store(&reported_ns, poll->elapsed_ns);
+}
+
+struct blocking {
+    int polls;
+    struct tachy_yield_handle yield;
+    tachy_state state;
+};
+
+enum tachy_poll blocking_poll(struct blocking *self, TACHY_UNUSED void *output) {
+    tachy_begin(&self->state);
+    for (self->polls = 0; self->polls < 8; self->polls++) {
+        self->yield = tachy_yield();
+        tachy_await(tachy_yield_poll(&self->yield, NULL));
+    }
+
+    struct timespec stall = {.tv_sec = 0, .tv_nsec = 100000000};
+    nanosleep(&stall, NULL);
+    tachy_return();
+    tachy_end;
+}
+
+void test_long_poll_reported_once(void) {
+    struct tachy_config config = {.watchdog_threshold_us = 20000, .watchdog_fn = on_long_poll};
+    bool initialised = tachy_init_with_config(&config);
+    assert(initialised);
+
+    struct blocking future = {0};
+    tachy_block_on(&future, (tachy_poll_fn) &blocking_poll, NULL);
+
+    assert(atomic_load(&reports) == 1);
+    assert(atomic_load(&reported_fn) == (tachy_poll_fn) &blocking_poll);
+    assert(atomic_load(&reported_ns) >= 20000000);
+
+    struct tachy_poll_histogram histograms[4];
+    size_t count = tachy_poll_histograms(histograms, 4);
+    assert(count == 1);
+    assert(histograms[0].poll_fn == (tachy_poll_fn) &blocking_poll);
+    assert(histograms[0].count == 9);
+
+    uint64_t slow = 0;
+    for (int i = 26; i < TACHY_POLL_HISTOGRAM_BUCKETS; i++) {
+        slow += histograms[0].buckets[i];
+    }
+    assert(slow == 1);
+
+    tachy_poll_histograms_reset();
+    assert(tachy_poll_histograms(histograms, 4) == 0);
+    tachy_shutdown();
+}
+
+void test_histograms_need_watchdog(void) {
+    bool initialised = tachy_init();
+    assert(initialised);
+
+    struct blocking future = {0};
+    tachy_block_on(&future, (tachy_poll_fn) &blocking_poll, NULL);
+    struct tachy_poll_histogram histograms[1];
+    assert(tachy_poll_histograms(histograms, 1) == 0);
+    tachy_shutdown();
+}
+
+int main(void) {
+    test_long_poll_reported_once();
+    printf("✅ test_long_poll_reported_once()\n");
+    test_histograms_need_watchdog();
+    printf("✅ test_histograms_need_watchdog()\n");
+    return 0;
+}